@@ -6,6 +6,13 @@ SmartFarmIoT::SmartFarmIoT(const char* device_id, const char* device_secret) {
   _server = "mqtt.smartfarm-platform.com"; // Placeholder Server Address
   client.setClient(espClient);
   client.setServer(_server, 1883);
+  client.setBufferSize(SFIOT_PAYLOAD_SIZE + 64);  // Room for topic + multi-sensor payload
+
+  // Topic is fixed, build it once
+  snprintf(_telemetry_topic, sizeof(_telemetry_topic), "farm/%s/telemetry", _device_id);
+  _value_count = 0;
+  _window_start = 0;
+  _coalesce_window = SFIOT_DEFAULT_COALESCE_WINDOW;
 }
 
 void SmartFarmIoT::begin(const char* ssid, const char* password) {
@@ -28,21 +35,98 @@ void SmartFarmIoT::loop() {
     reconnect();
   }
   client.loop();
+
+  // Publish collected values once the window closes
+  if (_value_count > 0 && millis() - _window_start >= _coalesce_window) {
+    flush();
+  }
 }
 
 void SmartFarmIoT::sendValue(const char* sensor_type, float value) {
-  // Topic: farm/{device_id}/telemetry
-  String topic = String("farm/") + _device_id + "/telemetry";
-  
-  // JSON Payload: { "sensor": "temp", "val": 25.5 }
-  StaticJsonDocument<200> doc;
-  doc["sensor"] = sensor_type;
-  doc["val"] = value;
-  
-  char buffer[256];
-  serializeJson(doc, buffer);
-  
-  client.publish(topic.c_str(), buffer);
+  // Names are written into JSON unescaped
+  size_t name_len = strlen(sensor_type);
+  if (name_len == 0 || name_len >= SFIOT_SENSOR_NAME_SIZE || strpbrk(sensor_type, "\"\\") != NULL) {
+    return;
+  }
+
+  // Window already over (loop() not called since, e.g. a node that reads
+  // and sleeps): publish it now instead of holding it back
+  if (_value_count > 0 && millis() - _window_start >= _coalesce_window) {
+    flush();
+  }
+
+  // Same sensor again: a new reading cycle started, publish the last one
+  // rather than overwrite its value
+  uint8_t i = 0;
+  while (i < _value_count && strcmp(_sensor_names[i], sensor_type) != 0) {
+    i++;
+  }
+
+  if (i < _value_count) {
+    if (!flush() && _value_count > 0) {
+      _sensor_values[i] = value;  // Offline: keep the latest reading
+      return;
+    }
+    i = 0;
+  }
+
+  if (i == _value_count) {
+    if (_value_count == SFIOT_MAX_VALUES && !flush()) {
+      return;  // Full and offline: drop rather than overwrite another sensor
+    }
+    if (_value_count == 0) {
+      _window_start = millis();
+    }
+    i = _value_count++;
+    strcpy(_sensor_names[i], sensor_type);
+  }
+  _sensor_values[i] = value;
+
+  if (_coalesce_window == 0) {
+    flush();
+  }
+}
+
+void SmartFarmIoT::setCoalesceWindow(unsigned long window_ms) {
+  _coalesce_window = window_ms;
+}
+
+bool SmartFarmIoT::flush() {
+  if (_value_count == 0) {
+    return true;
+  }
+
+  // Standard telemetry message (PROTOCOL.md), built in place:
+  // { "device_id": "...", "timestamp": 123, "protocol_version": "1.0", "sensors": { "temp": 25.5, ... } }
+  int len = snprintf(_payload, sizeof(_payload),
+                     "{\"device_id\":\"%s\",\"timestamp\":%lu,\"protocol_version\":\"%s\",\"sensors\":{",
+                     _device_id, _window_start / 1000, SFIOT_PROTOCOL_VERSION);
+
+  bool first = true;
+  for (uint8_t i = 0; i < _value_count && len < (int)sizeof(_payload); i++) {
+    if (isnan(_sensor_values[i]) || isinf(_sensor_values[i])) {
+      continue;  // Not representable in JSON
+    }
+    len += snprintf(_payload + len, sizeof(_payload) - len, "%s\"%s\":%.7g",
+                    first ? "" : ",", _sensor_names[i], _sensor_values[i]);
+    first = false;
+  }
+
+  if (len < (int)sizeof(_payload)) {
+    len += snprintf(_payload + len, sizeof(_payload) - len, "}}");
+  }
+  if (len >= (int)sizeof(_payload)) {
+    Serial.println("Telemetry payload too large, dropped");
+    _value_count = 0;
+    return false;
+  }
+
+  if (!client.publish(_telemetry_topic, _payload)) {
+    return false;  // Keep values, retried by the next loop() or sendValue()
+  }
+
+  _value_count = 0;
+  return true;
 }
 
 void SmartFarmIoT::reconnect() {
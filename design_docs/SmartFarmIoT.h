@@ -14,6 +14,12 @@
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
 
+#define SFIOT_PROTOCOL_VERSION "1.0"
+#define SFIOT_MAX_VALUES 12              // Distinct sensors per coalesced message
+#define SFIOT_SENSOR_NAME_SIZE 24
+#define SFIOT_PAYLOAD_SIZE 640
+#define SFIOT_DEFAULT_COALESCE_WINDOW 0  // ms; coalescing is opt-in
+
 class SmartFarmIoT {
   private:
     const char* _ssid;
@@ -25,13 +31,28 @@ class SmartFarmIoT {
     WiFiClient espClient;
     PubSubClient client;
 
+    // sendValue() coalescing: values collected here go out as one telemetry message
+    char _telemetry_topic[64];
+    char _sensor_names[SFIOT_MAX_VALUES][SFIOT_SENSOR_NAME_SIZE];
+    float _sensor_values[SFIOT_MAX_VALUES];
+    uint8_t _value_count;
+    unsigned long _window_start;  // millis() of the first value, sent as the timestamp
+    unsigned long _coalesce_window;
+    char _payload[SFIOT_PAYLOAD_SIZE];
+
     void reconnect();
 
   public:
     SmartFarmIoT(const char* device_id, const char* device_secret);
     void begin(const char* ssid, const char* password);
     void loop();
-    void sendValue(const char* sensor_type, float value);
+    // By default every sendValue() is published at once. With a window set,
+    // values are collected and published as one message once the window has
+    // passed (from loop() or the next sendValue()), or when a sensor repeats.
+    // Nodes that then deep-sleep must call flush() first.
+    void sendValue(const char* sensor_type, float value);  // See setCoalesceWindow()
+    void setCoalesceWindow(unsigned long window_ms);       // 0 (default) = publish every value immediately
+    bool flush();                                          // Publish collected values now
     void onCommand(void (*callback)(String, String)); // Callback for actions
 };
 
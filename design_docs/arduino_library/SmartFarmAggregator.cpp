@@ -0,0 +1,90 @@
+/*
+ * SmartFarm Sensor Aggregator - Implementation
+ * Version: 1.0.0
+ */
+
+#include "SmartFarmAggregator.h"
+
+SensorAggregator::SensorAggregator() {
+    this->channelCount = 0;
+}
+
+bool SensorAggregator::addChannel(const char* name, float (*read)(), float sampleRate, bool integrate) {
+    if (channelCount >= MAX_AGGREGATED_SENSORS || sampleRate <= 0) {
+        return false;
+    }
+    
+    Channel& channel = channels[channelCount++];
+    channel.name = name;
+    channel.read = read;
+    channel.period = (unsigned long)(1000000.0 / sampleRate);
+    channel.lastSample = 0;
+    channel.sampled = false;
+    channel.integrate = integrate;
+    channel.stats.reset();
+    return true;
+}
+
+void SensorAggregator::loop() {
+    unsigned long now = micros();
+    
+    for (uint8_t i = 0; i < channelCount; i++) {
+        Channel& channel = channels[i];
+        unsigned long elapsed = now - channel.lastSample;
+        
+        if (channel.sampled && elapsed < channel.period) {
+            continue;
+        }
+        
+        // A late loop() takes one sample, no catch-up burst; the integral uses the real gap
+        float dt = channel.sampled ? elapsed / 1000000.0 : 0;
+        channel.stats.add(channel.read(), dt);
+        channel.lastSample = now;
+        channel.sampled = true;
+    }
+}
+
+void SensorAggregator::writeSummary(JsonObject sensors, JsonObject stats) {
+    unsigned long now = micros();
+    
+    for (uint8_t i = 0; i < channelCount; i++) {
+        Channel& channel = channels[i];
+        if (channel.stats.getCount() == 0) {
+            if (channel.stats.getRejected() > 0) {
+                // Sensor failing for the whole window: say so rather than send nothing
+                JsonObject summary = stats.createNestedObject(channel.name);
+                summary["samples"] = 0;
+                summary["rejected"] = channel.stats.getRejected();
+            }
+            continue;
+        }
+        
+        sensors[channel.name] = channel.stats.getMean();
+        
+        JsonObject summary = stats.createNestedObject(channel.name);
+        summary["min"] = channel.stats.getMin();
+        summary["max"] = channel.stats.getMax();
+        summary["mean"] = channel.stats.getMean();
+        summary["stddev"] = channel.stats.getStdDev();
+        summary["p95"] = channel.stats.getP95();
+        summary["samples"] = channel.stats.getCount();
+        
+        if (channel.integrate) {
+            // Up to the window boundary: reset() starts the next one from here
+            float held = (now - channel.lastSample) / 1000000.0;
+            summary["energy_wh"] = channel.stats.getIntegral(held) / 3600.0;
+        }
+        if (channel.stats.getRejected() > 0) {
+            summary["rejected"] = channel.stats.getRejected();
+        }
+    }
+}
+
+void SensorAggregator::reset() {
+    unsigned long now = micros();
+    
+    for (uint8_t i = 0; i < channelCount; i++) {
+        Channel& channel = channels[i];
+        channel.stats.startWindow(channel.sampled ? (now - channel.lastSample) / 1000000.0 : 0);
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * SmartFarm Sensor Aggregator - Windowed High-Rate Sampling
+ * Version: 1.0.0
+ *
+ * Samples selected sensors at tens to hundreds of Hz between publishes
+ * and summarizes each window (min, max, mean, stddev, p95, energy), so
+ * short pump current spikes or flow transients are not lost. Failed
+ * reads are skipped and reported as "rejected".
+ */
+
+#ifndef SMARTFARM_AGGREGATOR_H
+#define SMARTFARM_AGGREGATOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "SmartFarmIoT.h"  // MAX_AGGREGATED_SENSORS, sized into the telemetry buffers
+#include "SmartFarmStats.h"
+
+#define DEFAULT_SAMPLE_RATE 50  // Hz
+
+class SensorAggregator {
+private:
+    struct Channel {
+        const char* name;           // Key in the telemetry message (must outlive the aggregator)
+        float (*read)();
+        unsigned long period;       // Microseconds between samples
+        unsigned long lastSample;   // micros() of previous sample
+        bool sampled;               // lastSample is set
+        bool integrate;             // Report energy_wh (value in W)
+        StreamingStats stats;
+    };
+    
+    Channel channels[MAX_AGGREGATED_SENSORS];
+    uint8_t channelCount;
+    
+public:
+    SensorAggregator();
+    
+    // Sample read() at sampleRate Hz; integrate = value is power (W), report energy
+    bool addChannel(const char* name, float (*read)(), float sampleRate = DEFAULT_SAMPLE_RATE, bool integrate = false);
+    
+    // Take due samples; call on every loop() iteration
+    void loop();
+    
+    // sensors[name] = window mean (compatible with single-value readers),
+    // stats[name] = { min, max, mean, stddev, p95, samples, energy_wh, rejected }
+    // (rejected only after failed reads; a channel with no good read reports
+    // { samples: 0, rejected } and no sensors entry). energy_wh runs up to now.
+    void writeSummary(JsonObject sensors, JsonObject stats);
+    
+    // Start a new window (after publishing). The energy between the last
+    // sample and now went to the closed window; none is lost at the boundary.
+    void reset();
+};
+
+#endif // SMARTFARM_AGGREGATOR_H
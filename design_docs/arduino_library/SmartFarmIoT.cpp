@@ -12,7 +12,24 @@ SmartFarmIoT* SmartFarmIoT::_instance = nullptr;
 SmartFarmIoT::SmartFarmIoT(const char* deviceId, const char* deviceToken) {
     _deviceId = String(deviceId);
     _deviceToken = String(deviceToken);
-    _mqttPort = DEFAULT_MQTT_PORT;
+    _brokerCount = 0;
+    _activeBroker = -1;
+    _lastBroker = -1;
+    _failoverCount = 0;
+    _failoverTimeout = DEFAULT_FAILOVER_TIMEOUT;
+    _probeInterval = DEFAULT_BROKER_PROBE_INTERVAL;
+    _lastProbeTime = 0;
+    _lastReconnectAttempt = 0;
+    _bufferUsed = 0;
+    _bufferCount = 0;
+    _groupCount = 0;
+    _responseJitter = DEFAULT_RESPONSE_JITTER;
+    _recentFanoutNext = 0;
+    _currentReceivedAt = 0;
+    _respondedInCallback = false;
+    for (int i = 0; i < MAX_PENDING_RESPONSES; i++) {
+        _pendingResponses[i].active = false;
+    }
     _sendInterval = DEFAULT_SEND_INTERVAL;
     _lastSendTime = 0;
     _commandCallback = nullptr;
@@ -27,9 +44,12 @@ SmartFarmIoT::SmartFarmIoT(const char* deviceId, const char* deviceToken) {
 
 // Setup WiFi and MQTT
 void SmartFarmIoT::begin(const char* ssid, const char* password, const char* mqttServer, int mqttPort) {
-    _mqttServer = String(mqttServer);
-    _mqttPort = mqttPort;
-    
+    addBroker(mqttServer, mqttPort);
+    begin(ssid, password);
+}
+
+// Setup WiFi and MQTT using the registered broker list
+void SmartFarmIoT::begin(const char* ssid, const char* password) {
     // Connect to WiFi
     Serial.print("Connecting to WiFi");
     WiFi.begin(ssid, password);
@@ -45,12 +65,20 @@ void SmartFarmIoT::begin(const char* ssid, const char* password, const char* mqt
     
     // Setup MQTT
     _mqttClient.setClient(_wifiClient);
-    _mqttClient.setServer(_mqttServer.c_str(), _mqttPort);
+    _mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+    setFailoverTimeout(_failoverTimeout);
+#if defined(ESP8266) || defined(ESP32)
+    // PubSubClient takes a std::function here, so every instance gets its own messages
+    _mqttClient.setCallback([this](char* topic, byte* payload, unsigned int length) {
+        mqttCallback(topic, payload, length);
+    });
+#else
     _mqttClient.setCallback([](char* topic, byte* payload, unsigned int length) {
         if (_instance) {
             _instance->mqttCallback(topic, payload, length);
         }
     });
+#endif
     
     reconnectMQTT();
 }
@@ -59,46 +87,223 @@ void SmartFarmIoT::begin(const char* ssid, const char* password, const char* mqt
 void SmartFarmIoT::loop() {
     if (!_mqttClient.connected()) {
         reconnectMQTT();
+    } else {
+        checkPreferredBrokers();
     }
     _mqttClient.loop();
+    sendPendingResponses(false);
 }
 
-// Reconnect to MQTT
+// Add broker to the failover list (lower index = preferred)
+bool SmartFarmIoT::addBroker(const char* host, int port) {
+    if (_brokerCount >= MAX_BROKERS) {
+        return false;
+    }
+    
+    BrokerEndpoint& broker = _brokers[_brokerCount++];
+    broker.host = String(host);
+    broker.port = port;
+    broker.latency = 0;
+    broker.lastAttempt = 0;
+    broker.failures = 0;
+    broker.healthy = true;  // Unknown until first attempt
+    return true;
+}
+
+// Fallback broker used when the preferred one is unreachable
+bool SmartFarmIoT::setSecondaryBroker(const char* host, int port) {
+    return addBroker(host, port);
+}
+
+// Bound the time spent detecting a dead broker and connecting to the next one
+void SmartFarmIoT::setFailoverTimeout(unsigned long timeout) {
+    _failoverTimeout = timeout;
+    
+    // Half the budget detects the dead link (PubSubClient gives up after 1.5x keepalive),
+    // the other half is shared by connect attempts to the remaining brokers
+    uint16_t keepAlive = max(1UL, timeout / 3000);
+    unsigned long connectTimeout = max(1000UL, timeout / (2UL * max(1, _brokerCount)));
+    _mqttClient.setKeepAlive(keepAlive);
+    _mqttClient.setSocketTimeout(max(1UL, connectTimeout / 1000));  // Only the wait for CONNACK
+    
+    // PubSubClient opens the TCP connection with the client's own timeout, which
+    // is what a blackholed broker costs
+#if defined(ESP32) && (!defined(ESP_ARDUINO_VERSION_MAJOR) || ESP_ARDUINO_VERSION_MAJOR < 3)
+    _wifiClient.setTimeout(max(1UL, connectTimeout / 1000));  // Seconds before ESP32 core 3.0
+#else
+    _wifiClient.setTimeout(connectTimeout);
+#endif
+}
+
+// Set how often preferred brokers are probed while on a fallback
+void SmartFarmIoT::setProbeInterval(unsigned long interval) {
+    _probeInterval = interval;
+}
+
+// Reconnect to MQTT (one pass over the broker list, never blocks forever)
 void SmartFarmIoT::reconnectMQTT() {
-    while (!_mqttClient.connected()) {
-        Serial.print("Connecting to MQTT...");
-        
-        if (_mqttClient.connect(_deviceId.c_str(), _deviceId.c_str(), _deviceToken.c_str())) {
-            Serial.println("connected!");
-            
-            // Subscribe to command topic
-            _mqttClient.subscribe(_commandTopic.c_str(), 1);  // QoS 1
+    if (_brokerCount == 0) {
+        return;
+    }
+    
+    if (_lastReconnectAttempt != 0 && millis() - _lastReconnectAttempt < DEFAULT_RECONNECT_DELAY) {
+        return;
+    }
+    
+    // The broker we just lost and brokers that failed recently are tried last,
+    // so a dead preferred broker doesn't delay failover
+    int previous = _lastBroker;
+    _activeBroker = -1;
+    
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < _brokerCount; i++) {
+            BrokerEndpoint& broker = _brokers[i];
+            bool recentlyFailed = !broker.healthy && millis() - broker.lastAttempt < _probeInterval;
             
-            // Send online status
-            sendStatus("online", millis() / 1000, PROTOCOL_VERSION);
+            if (pass == 0 && (i == previous || recentlyFailed)) {
+                continue;
+            }
+            if (pass == 1 && !(i == previous || recentlyFailed)) {
+                continue;
+            }
             
-        } else {
-            Serial.print("failed, rc=");
-            Serial.print(_mqttClient.state());
-            Serial.println(" retrying in 5s");
-            delay(5000);
+            if (connectBroker(i)) {
+                _lastReconnectAttempt = 0;
+                return;
+            }
         }
     }
+    
+    Serial.println("All brokers unreachable, retrying in 5s");
+    _lastReconnectAttempt = millis();
 }
 
-// Send telemetry data
-bool SmartFarmIoT::sendTelemetry(JsonObject sensors, float batteryVoltage, int rssi) {
-    if (!_mqttClient.connected()) {
+// Connect to a single broker, measuring latency
+bool SmartFarmIoT::connectBroker(int index) {
+    BrokerEndpoint& broker = _brokers[index];
+    
+    Serial.print("Connecting to MQTT " + broker.host + ":" + String(broker.port) + "...");
+    
+    _mqttClient.setServer(broker.host.c_str(), broker.port);
+    unsigned long start = millis();
+    bool connected = _mqttClient.connect(_deviceId.c_str(), _deviceId.c_str(), _deviceToken.c_str());
+    broker.lastAttempt = millis();
+    
+    if (!connected) {
+        broker.healthy = false;
+        broker.failures++;
+        Serial.print("failed, rc=");
+        Serial.println(_mqttClient.state());
         return false;
     }
     
-    // Create JSON document
-    StaticJsonDocument<512> doc;
+    broker.latency = broker.lastAttempt - start;
+    broker.healthy = true;
+    broker.failures = 0;
+    _activeBroker = index;
+    _lastProbeTime = millis();
+    
+    // Counted before the status message so it reports the switch
+    if (_lastBroker >= 0 && _lastBroker != index) {
+        _failoverCount++;
+    }
+    _lastBroker = index;
+    
+    Serial.println("connected! (" + String(broker.latency) + " ms)");
+    
+    // Subscribe to command topic
+    _mqttClient.subscribe(_commandTopic.c_str(), 1);  // QoS 1
+    subscribeFanoutTopics();
+    
+    // Send online status
+    sendStatus("online", millis() / 1000, PROTOCOL_VERSION);
+    
+    flushTelemetryBuffer();
+    return true;
+}
+
+// TCP-level health check on a separate socket. The MQTT session stays up, but
+// loop() is blocked for up to DEFAULT_PROBE_TIMEOUT while the connect is pending.
+bool SmartFarmIoT::probeBroker(int index) {
+    BrokerEndpoint& broker = _brokers[index];
+    
+    unsigned long start = millis();
+#ifdef ESP32
+    bool reachable = _probeClient.connect(broker.host.c_str(), broker.port, DEFAULT_PROBE_TIMEOUT);
+#else
+    _probeClient.setTimeout(DEFAULT_PROBE_TIMEOUT);  // ESP8266 uses the stream timeout for connect
+    bool reachable = _probeClient.connect(broker.host.c_str(), broker.port);
+#endif
+    broker.lastAttempt = millis();
+    _probeClient.stop();
+    
+    if (reachable) {
+        broker.latency = broker.lastAttempt - start;
+        broker.healthy = true;
+        broker.failures = 0;
+    } else {
+        broker.healthy = false;
+        broker.failures++;
+    }
+    return reachable;
+}
+
+// Return to a more preferred broker once it recovers. Only brokers ahead of the
+// active one are probed (nothing on the primary), most preferred first.
+void SmartFarmIoT::checkPreferredBrokers() {
+    if (_activeBroker <= 0 || millis() - _lastProbeTime < _probeInterval) {
+        return;
+    }
+    _lastProbeTime = millis();
+    
+    int preferred = -1;
+    for (int i = 0; i < _activeBroker; i++) {
+        if (probeBroker(i)) {
+            preferred = i;
+            break;
+        }
+    }
+    
+    if (preferred < 0) {
+        return;
+    }
+    
+    // Telemetry is published synchronously, so nothing is in flight here
+    int previous = _activeBroker;
+    Serial.println("Preferred broker " + _brokers[preferred].host + " recovered, switching back");
+    _mqttClient.disconnect();
+    _activeBroker = -1;
+    
+    // If both fail, loop() sees the dropped session and reconnectMQTT() takes over
+    if (!connectBroker(preferred)) {
+        connectBroker(previous);
+    }
+}
+
+// Send telemetry data
+bool SmartFarmIoT::sendTelemetry(JsonObject sensors, float batteryVoltage, int rssi) {
+    // No stats: don't put the aggregator-sized document on the stack
+    StaticJsonDocument<TELEMETRY_BASE_DOC_SIZE> doc;
+    return publishTelemetry(doc, sensors, JsonObject(), batteryVoltage, rssi);
+}
+
+// Send telemetry data with per-sensor window statistics
+bool SmartFarmIoT::sendTelemetry(JsonObject sensors, JsonObject stats, float batteryVoltage, int rssi) {
+    StaticJsonDocument<TELEMETRY_DOC_SIZE> doc;
+    return publishTelemetry(doc, sensors, stats, batteryVoltage, rssi);
+}
+
+// Fill doc (sized by the caller) and publish, or buffer while no broker is reachable
+bool SmartFarmIoT::publishTelemetry(JsonDocument& doc, JsonObject sensors, JsonObject stats, float batteryVoltage, int rssi) {
     doc["device_id"] = _deviceId;
     doc["timestamp"] = millis() / 1000;  // Simple timestamp (use NTP for real time)
     doc["protocol_version"] = PROTOCOL_VERSION;
     doc["sensors"] = sensors;
     
+    if (!stats.isNull()) {
+        doc["stats"] = stats;
+    }
+    
     if (batteryVoltage > 0) {
         doc["battery_voltage"] = batteryVoltage;
     }
@@ -109,16 +314,30 @@ bool SmartFarmIoT::sendTelemetry(JsonObject sensors, float batteryVoltage, int r
         doc["rssi"] = getRSSI();
     }
     
+    // A truncated message would pass as valid telemetry with fields missing
+    if (doc.overflowed()) {
+        Serial.println("❌ Telemetry larger than its JsonDocument, not sent");
+        return false;
+    }
+    
     // Serialize to string
     String payload;
     serializeJson(doc, payload);
     
+    // Keep data while failing over; it goes out once a broker accepts us
+    if (!_mqttClient.connected()) {
+        bufferTelemetry(payload.c_str());
+        Serial.println("📦 Telemetry buffered (no broker)");
+        return false;
+    }
+    
     // Publish (QoS 0 for telemetry)
     bool success = _mqttClient.publish(_telemetryTopic.c_str(), payload.c_str(), false);
     
     if (success) {
         Serial.println("📤 Telemetry sent: " + payload);
     } else {
+        bufferTelemetry(payload.c_str());
         Serial.println("❌ Failed to send telemetry");
     }
     
@@ -131,12 +350,20 @@ bool SmartFarmIoT::sendStatus(const char* status, unsigned long uptime, const ch
         return false;
     }
     
-    StaticJsonDocument<256> doc;
+    StaticJsonDocument<STATUS_DOC_SIZE> doc;
     doc["device_id"] = _deviceId;
     doc["status"] = status;
     doc["uptime"] = uptime;
     doc["firmware_version"] = firmwareVersion;
     doc["free_memory"] = ESP.getFreeHeap();
+    doc["broker"] = getActiveBroker();
+    doc["broker_latency"] = getBrokerLatency(_activeBroker);
+    doc["failover_count"] = _failoverCount;
+    
+    if (doc.overflowed()) {
+        Serial.println("❌ Status larger than STATUS_DOC_SIZE, not sent");
+        return false;
+    }
     
     String payload;
     serializeJson(doc, payload);
@@ -145,26 +372,147 @@ bool SmartFarmIoT::sendStatus(const char* status, unsigned long uptime, const ch
     return _mqttClient.publish(_statusTopic.c_str(), payload.c_str(), true);
 }
 
+// Store serialized telemetry at its length (drops oldest when full)
+void SmartFarmIoT::bufferTelemetry(const char* payload) {
+    size_t size = strlen(payload) + 1;
+    if (size > TELEMETRY_BUFFER_BYTES) {
+        Serial.println("❌ Telemetry larger than TELEMETRY_BUFFER_BYTES (" + String((unsigned long)size) + " bytes), dropped");
+        return;
+    }
+    
+    while (_bufferCount == TELEMETRY_BUFFER_SIZE || _bufferUsed + size > TELEMETRY_BUFFER_BYTES) {
+        dropOldestTelemetry();
+    }
+    memcpy(_telemetryBuffer + _bufferUsed, payload, size);
+    _bufferUsed += size;
+    _bufferCount++;
+}
+
+// Messages are moved down rather than wrapped, so each one stays contiguous
+// for publish(); this only runs while offline or replaying
+void SmartFarmIoT::dropOldestTelemetry() {
+    size_t size = strlen(_telemetryBuffer) + 1;
+    memmove(_telemetryBuffer, _telemetryBuffer + size, _bufferUsed - size);
+    _bufferUsed -= size;
+    _bufferCount--;
+}
+
+// Publish buffered telemetry in original order
+void SmartFarmIoT::flushTelemetryBuffer() {
+    while (_bufferCount > 0 && _mqttClient.connected()) {
+        if (!_mqttClient.publish(_telemetryTopic.c_str(), _telemetryBuffer, false)) {
+            return;
+        }
+        dropOldestTelemetry();
+    }
+}
+
 // Send command response
 bool SmartFarmIoT::sendCommandResponse(const char* requestId, bool success, const char* message) {
+    // Fan-out commands are answered after a random delay (see sendPendingResponses)
+    if (_currentScope.length() > 0 && _currentRequestId == requestId) {
+        queueResponse(requestId, success, message);
+        return true;
+    }
+    
+    return publishResponse(requestId, success, message, "", 0);
+}
+
+// Publish a response on farm/{device_id}/response
+bool SmartFarmIoT::publishResponse(const char* requestId, bool success, const char* message,
+                                   const String& scope, unsigned long latency) {
     if (!_mqttClient.connected()) {
         return false;
     }
     
-    StaticJsonDocument<256> doc;
+    StaticJsonDocument<384> doc;
     doc["request_id"] = requestId;
     doc["status"] = success ? "success" : "error";
     doc["message"] = message;
     doc["timestamp"] = millis() / 1000;
     
+    // Lets the platform aggregate one fan-out command across devices
+    if (scope.length() > 0) {
+        doc["device_id"] = _deviceId;
+        doc["scope"] = scope;
+        doc["latency"] = latency;
+    }
+    
     String payload;
     serializeJson(doc, payload);
     
     return _mqttClient.publish(_responseTopic.c_str(), payload.c_str(), false);
 }
 
+// Hold a fan-out response until its jittered due time; repeated calls for the
+// same request are merged (error wins, last message kept). Commands without a
+// request_id can't be told apart, so each keeps its own response.
+void SmartFarmIoT::queueResponse(const char* requestId, bool success, const char* message) {
+    _respondedInCallback = true;
+    
+    int freeSlot = -1;
+    for (int i = 0; i < MAX_PENDING_RESPONSES; i++) {
+        PendingResponse& pending = _pendingResponses[i];
+        if (pending.active && requestId[0] != '\0' && pending.requestId == requestId) {
+            pending.success = pending.success && success;
+            pending.message = message;
+            return;
+        }
+        if (!pending.active && freeSlot < 0) {
+            freeSlot = i;
+        }
+    }
+    
+    if (freeSlot < 0) {
+        // Queue full: answer now rather than not at all
+        publishResponse(requestId, success, message, _currentScope, millis() - _currentReceivedAt);
+        return;
+    }
+    
+    PendingResponse& pending = _pendingResponses[freeSlot];
+    pending.requestId = requestId;
+    pending.message = message;
+    pending.scope = _currentScope;
+    pending.success = success;
+    pending.receivedAt = _currentReceivedAt;
+    pending.dueTime = _currentReceivedAt + random(0, _responseJitter + 1);
+    pending.active = true;
+}
+
+// Send fan-out responses whose delay has expired (or all of them)
+void SmartFarmIoT::sendPendingResponses(bool ignoreDelay) {
+    unsigned long now = millis();
+    
+    for (int i = 0; i < MAX_PENDING_RESPONSES; i++) {
+        PendingResponse& pending = _pendingResponses[i];
+        if (!pending.active || (!ignoreDelay && (long)(now - pending.dueTime) < 0)) {
+            continue;
+        }
+        
+        if (publishResponse(pending.requestId.c_str(), pending.success, pending.message.c_str(),
+                            pending.scope, now - pending.receivedAt)) {
+            pending.active = false;
+        }
+    }
+}
+
 // MQTT callback for incoming messages
 void SmartFarmIoT::mqttCallback(char* topic, byte* payload, unsigned int length) {
+    // Which topic did this arrive on?
+    String topicName = String(topic);
+    String scope = "";
+    
+    if (_farmId.length() > 0 && topicName == farmCommandTopic()) {
+        scope = "farm";
+    } else {
+        for (int i = 0; i < _groupCount; i++) {
+            if (topicName == groupCommandTopic(_groups[i])) {
+                scope = "group:" + _groups[i];
+                break;
+            }
+        }
+    }
+    
     // Parse JSON
     StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, payload, length);
@@ -178,12 +526,53 @@ void SmartFarmIoT::mqttCallback(char* topic, byte* payload, unsigned int length)
     String requestId = doc["request_id"] | "";
     JsonObject params = doc["params"];
     
-    Serial.println("📥 Command received: " + command);
+    // A device in several targeted groups gets the same fan-out more than once
+    if (scope.length() > 0 && seenFanoutRequest(requestId)) {
+        return;
+    }
+    
+    Serial.println("📥 Command received: " + command + (scope.length() > 0 ? " (" + scope + ")" : String("")));
     
-    // Call user callback
-    if (_commandCallback) {
+    _currentRequestId = requestId;
+    _currentScope = scope;
+    _currentReceivedAt = millis();
+    _respondedInCallback = false;
+    
+    // Group membership is managed by the platform at runtime
+    if (command == "join_group" || command == "leave_group") {
+        String group = params["group"] | "";
+        bool ok = command == "join_group" ? joinGroup(group.c_str()) : leaveGroup(group.c_str());
+        sendCommandResponse(requestId.c_str(), ok, ok ? "Group updated" : "Group update failed");
+    } else if (_commandCallback) {
+        // Call user callback
         _commandCallback(command, params);
     }
+    
+    // Every device answers a fan-out command exactly once
+    if (scope.length() > 0 && !_respondedInCallback) {
+        queueResponse(requestId.c_str(), true, "OK");
+    }
+    
+    _currentRequestId = "";
+    _currentScope = "";
+}
+
+// True if this fan-out request_id was handled recently; remembers new ones.
+// The copies of one fan-out can arrive interleaved with other commands.
+bool SmartFarmIoT::seenFanoutRequest(const String& requestId) {
+    if (requestId.length() == 0) {
+        return false;
+    }
+    
+    for (int i = 0; i < RECENT_FANOUT_IDS; i++) {
+        if (_recentFanoutIds[i] == requestId) {
+            return true;
+        }
+    }
+    
+    _recentFanoutIds[_recentFanoutNext] = requestId;
+    _recentFanoutNext = (_recentFanoutNext + 1) % RECENT_FANOUT_IDS;
+    return false;
 }
 
 // Register command callback
@@ -191,6 +580,100 @@ void SmartFarmIoT::onCommand(void (*callback)(String command, JsonObject params)
     _commandCallback = callback;
 }
 
+// request_id of the command passed to the callback ("" outside the callback)
+String SmartFarmIoT::getCurrentRequestId() {
+    return _currentRequestId;
+}
+
+String SmartFarmIoT::farmCommandTopic() {
+    return "fleet/" + _farmId + "/command";
+}
+
+String SmartFarmIoT::groupCommandTopic(const String& group) {
+    return "fleet/" + _farmId + "/group/" + group + "/command";
+}
+
+// Subscribe to farm and group command topics (after every connect)
+void SmartFarmIoT::subscribeFanoutTopics() {
+    if (_farmId.length() == 0 || !_mqttClient.connected()) {
+        return;
+    }
+    
+    _mqttClient.subscribe(farmCommandTopic().c_str(), 1);
+    for (int i = 0; i < _groupCount; i++) {
+        _mqttClient.subscribe(groupCommandTopic(_groups[i]).c_str(), 1);
+    }
+}
+
+// Set farm for farm-wide commands (groups are scoped to the farm)
+void SmartFarmIoT::setFarmId(const char* farmId) {
+    if (_farmId.length() > 0 && _mqttClient.connected()) {
+        _mqttClient.unsubscribe(farmCommandTopic().c_str());
+        for (int i = 0; i < _groupCount; i++) {
+            _mqttClient.unsubscribe(groupCommandTopic(_groups[i]).c_str());
+        }
+    }
+    
+    _farmId = String(farmId);
+    subscribeFanoutTopics();
+}
+
+// Receive commands sent to a group (e.g. "zone_a_pumps")
+bool SmartFarmIoT::joinGroup(const char* group) {
+    String name = String(group);
+    if (name.length() == 0 || name.indexOf('/') >= 0 || name.indexOf('+') >= 0 || name.indexOf('#') >= 0) {
+        return false;
+    }
+    
+    for (int i = 0; i < _groupCount; i++) {
+        if (_groups[i] == name) {
+            return true;
+        }
+    }
+    
+    if (_groupCount >= MAX_COMMAND_GROUPS) {
+        return false;
+    }
+    
+    _groups[_groupCount++] = name;
+    if (_farmId.length() > 0 && _mqttClient.connected()) {
+        _mqttClient.subscribe(groupCommandTopic(name).c_str(), 1);
+    }
+    return true;
+}
+
+// Stop receiving commands sent to a group
+bool SmartFarmIoT::leaveGroup(const char* group) {
+    String name = String(group);
+    
+    for (int i = 0; i < _groupCount; i++) {
+        if (_groups[i] != name) {
+            continue;
+        }
+        
+        if (_farmId.length() > 0 && _mqttClient.connected()) {
+            _mqttClient.unsubscribe(groupCommandTopic(name).c_str());
+        }
+        for (int j = i; j < _groupCount - 1; j++) {
+            _groups[j] = _groups[j + 1];
+        }
+        _groupCount--;
+        return true;
+    }
+    return false;
+}
+
+// Spread fan-out responses over [0, maxDelay] ms to avoid a burst on the broker
+void SmartFarmIoT::setResponseJitter(unsigned long maxDelay) {
+    _responseJitter = maxDelay;
+}
+
+// Send every queued fan-out response now. Call before ESP.restart() or deep
+// sleep, otherwise responses still waiting for their random delay are lost.
+void SmartFarmIoT::flushResponses() {
+    sendPendingResponses(true);
+}
+
 // Set send interval
 void SmartFarmIoT::setSendInterval(unsigned long interval) {
     _sendInterval = interval;
@@ -210,3 +693,24 @@ int SmartFarmIoT::getRSSI() {
 String SmartFarmIoT::getDeviceId() {
     return _deviceId;
 }
+
+// Get active broker as host:port ("" when disconnected)
+String SmartFarmIoT::getActiveBroker() {
+    if (_activeBroker < 0) {
+        return "";
+    }
+    return _brokers[_activeBroker].host + ":" + String(_brokers[_activeBroker].port);
+}
+
+// Get number of times the device switched brokers
+unsigned long SmartFarmIoT::getFailoverCount() {
+    return _failoverCount;
+}
+
+// Get last measured connect latency for a broker (ms)
+unsigned long SmartFarmIoT::getBrokerLatency(int index) {
+    if (index < 0 || index >= _brokerCount) {
+        return 0;
+    }
+    return _brokers[index].latency;
+}
\ No newline at end of file
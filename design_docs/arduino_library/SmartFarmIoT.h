@@ -25,6 +25,89 @@
 #define DEFAULT_MQTT_PORT 1883
 #define DEFAULT_SEND_INTERVAL 5000  // 5 seconds
 
+// Broker failover settings
+#define MAX_BROKERS 4
+#define DEFAULT_FAILOVER_TIMEOUT 15000      // Max time to detect a dead broker and move on
+#define DEFAULT_BROKER_PROBE_INTERVAL 30000 // How often to re-check preferred brokers
+#define DEFAULT_RECONNECT_DELAY 5000        // Pause after every broker failed
+#define DEFAULT_PROBE_TIMEOUT 250           // TCP connect timeout (ms) when probing a preferred broker
+
+// Sizes below can be overridden with compiler flags (e.g. PlatformIO
+// build_flags = -DMAX_AGGREGATED_SENSORS=2). A #define in the sketch is not
+// seen by the library's own .cpp files, so don't set them there.
+
+// Windowed statistics (SensorAggregator). Each channel adds a "stats"
+// object to the telemetry message, so the sizes below grow with it.
+#ifndef MAX_AGGREGATED_SENSORS
+#define MAX_AGGREGATED_SENSORS 6
+#endif
+#ifndef STATS_JSON_SIZE
+#define STATS_JSON_SIZE 224  // Serialized stats object of one channel, worst case
+#endif
+#ifndef STATS_DOC_SIZE
+#define STATS_DOC_SIZE 192   // JsonDocument memory for one channel (at most 8 members)
+#endif
+
+// Telemetry without stats (sensors, device fields)
+#ifndef TELEMETRY_BASE_JSON_SIZE
+#define TELEMETRY_BASE_JSON_SIZE 512
+#endif
+#ifndef TELEMETRY_BASE_DOC_SIZE
+#define TELEMETRY_BASE_DOC_SIZE 512
+#endif
+#ifndef TELEMETRY_PAYLOAD_SIZE
+#define TELEMETRY_PAYLOAD_SIZE (TELEMETRY_BASE_JSON_SIZE + MAX_AGGREGATED_SENSORS * STATS_JSON_SIZE)
+#endif
+#ifndef TELEMETRY_DOC_SIZE
+#define TELEMETRY_DOC_SIZE (TELEMETRY_BASE_DOC_SIZE + MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE)
+#endif
+
+// Telemetry kept while no broker is reachable (oldest dropped first): up to
+// TELEMETRY_BUFFER_SIZE messages, stored at their serialized length in
+// TELEMETRY_BUFFER_BYTES. A message larger than that is not buffered.
+#ifndef TELEMETRY_BUFFER_SIZE
+#define TELEMETRY_BUFFER_SIZE 8
+#endif
+#ifndef TELEMETRY_BUFFER_BYTES
+#define TELEMETRY_BUFFER_BYTES 4096
+#endif
+
+// Status message: 8 members plus the copied device id and broker strings
+#ifndef STATUS_DOC_SIZE
+#define STATUS_DOC_SIZE 384
+#endif
+
+// PubSubClient buffer (default 256 bytes): largest payload plus topic and header.
+// Also covers the status message (~250 bytes with broker fields).
+#ifndef MQTT_BUFFER_SIZE
+#define MQTT_BUFFER_SIZE (TELEMETRY_PAYLOAD_SIZE + 128)
+#endif
+
+// Farm / group command fan-out
+#define MAX_COMMAND_GROUPS 4
+#define MAX_PENDING_RESPONSES 4
+#define DEFAULT_RESPONSE_JITTER 2000  // Max random delay (ms) before answering a fan-out command
+#define RECENT_FANOUT_IDS 8           // Fan-out request_ids remembered to drop duplicates
+
+struct BrokerEndpoint {
+    String host;
+    int port;
+    unsigned long latency;      // Last measured connect latency (ms)
+    unsigned long lastAttempt;  // millis() of last connect or probe
+    uint8_t failures;           // Consecutive failed attempts
+    bool healthy;
+};
+
+struct PendingResponse {
+    String requestId;
+    String message;
+    String scope;               // "farm" or "group:<id>"
+    bool success;
+    unsigned long receivedAt;   // millis() when the command arrived
+    unsigned long dueTime;      // millis() when the response may be sent
+    bool active;
+};
+
 class SmartFarmIoT {
 private:
     // Device credentials
@@ -32,17 +115,46 @@ private:
     String _deviceToken;
     
     // MQTT settings
-    String _mqttServer;
-    int _mqttPort;
+    BrokerEndpoint _brokers[MAX_BROKERS];  // Ordered by preference (index 0 first)
+    int _brokerCount;
+    int _activeBroker;                     // -1 when disconnected
+    int _lastBroker;                       // Last broker connected to (-1 before the first connect)
+    unsigned long _failoverCount;
+    unsigned long _failoverTimeout;
+    unsigned long _probeInterval;
+    unsigned long _lastProbeTime;
+    unsigned long _lastReconnectAttempt;
     WiFiClient _wifiClient;
+    WiFiClient _probeClient;
     PubSubClient _mqttClient;
     
+    // Telemetry buffered while offline or switching brokers
+    // NUL-terminated payloads back to back, oldest first
+    char _telemetryBuffer[TELEMETRY_BUFFER_BYTES];
+    size_t _bufferUsed;
+    uint8_t _bufferCount;
+    
     // Topics
     String _telemetryTopic;
     String _statusTopic;
     String _commandTopic;
     String _responseTopic;
     
+    // Fan-out command topics (fleet/{farm_id}/command, fleet/{farm_id}/group/{group}/command)
+    String _farmId;
+    String _groups[MAX_COMMAND_GROUPS];
+    int _groupCount;
+    unsigned long _responseJitter;
+    PendingResponse _pendingResponses[MAX_PENDING_RESPONSES];
+    String _recentFanoutIds[RECENT_FANOUT_IDS];  // Ring, oldest overwritten
+    uint8_t _recentFanoutNext;
+    
+    // Context of the command currently passed to the callback
+    String _currentRequestId;
+    String _currentScope;
+    unsigned long _currentReceivedAt;
+    bool _respondedInCallback;
+    
     // Timing
     unsigned long _lastSendTime;
     unsigned long _sendInterval;
@@ -52,6 +164,21 @@ private:
     
     // Internal methods
     void reconnectMQTT();
+    bool connectBroker(int index);
+    bool probeBroker(int index);
+    void checkPreferredBrokers();
+    bool publishTelemetry(JsonDocument& doc, JsonObject sensors, JsonObject stats, float batteryVoltage, int rssi);
+    void bufferTelemetry(const char* payload);
+    void dropOldestTelemetry();
+    void flushTelemetryBuffer();
+    String farmCommandTopic();
+    String groupCommandTopic(const String& group);
+    void subscribeFanoutTopics();
+    bool seenFanoutRequest(const String& requestId);
+    void queueResponse(const char* requestId, bool success, const char* message);
+    void sendPendingResponses(bool ignoreDelay);
+    bool publishResponse(const char* requestId, bool success, const char* message,
+                         const String& scope, unsigned long latency);
     void mqttCallback(char* topic, byte* payload, unsigned int length);
     static SmartFarmIoT* _instance;  // For callback
     
@@ -61,23 +188,42 @@ public:
     
     // Setup
     void begin(const char* ssid, const char* password, const char* mqttServer, int mqttPort = DEFAULT_MQTT_PORT);
+    void begin(const char* ssid, const char* password);  // Uses brokers from addBroker()
     void setSendInterval(unsigned long interval);
     
+    // Brokers are tried in the order they are added (e.g. local edge hub first, cloud last)
+    bool addBroker(const char* host, int port = DEFAULT_MQTT_PORT);
+    bool setSecondaryBroker(const char* host, int port = DEFAULT_MQTT_PORT);
+    void setFailoverTimeout(unsigned long timeout);
+    void setProbeInterval(unsigned long interval);
+    
     // Main loop
     void loop();
     
     // Send data
     bool sendTelemetry(JsonObject sensors, float batteryVoltage = 0, int rssi = 0);
+    bool sendTelemetry(JsonObject sensors, JsonObject stats, float batteryVoltage = 0, int rssi = 0);  // With window summaries (SensorAggregator)
     bool sendStatus(const char* status, unsigned long uptime, const char* firmwareVersion);
     bool sendCommandResponse(const char* requestId, bool success, const char* message);
     
     // Receive commands
     void onCommand(void (*callback)(String command, JsonObject params));
+    String getCurrentRequestId();  // request_id of the command being handled
+    
+    // Fan-out commands (one publish reaches every device of a farm or group)
+    void setFarmId(const char* farmId);
+    bool joinGroup(const char* group);
+    bool leaveGroup(const char* group);
+    void setResponseJitter(unsigned long maxDelay);
+    void flushResponses();  // Send delayed fan-out responses now (before restart or deep sleep)
     
     // Utility
     bool isConnected();
     int getRSSI();
     String getDeviceId();
+    String getActiveBroker();
+    unsigned long getFailoverCount();
+    unsigned long getBrokerLatency(int index);
 };
 
 #endif // SMARTFARMIOT_H
@@ -163,11 +163,11 @@ void FlowRateSensor::pulseCounter() {
     pulseCount++;
 }
 
-float FlowRateSensor::readFlowRate() {
+float FlowRateSensor::readFlowRate(unsigned long minInterval) {
     unsigned long currentTime = millis();
     unsigned long elapsedTime = currentTime - lastTime;
     
-    if (elapsedTime >= 1000) {  // Calculate every second
+    if (elapsedTime >= minInterval && elapsedTime > 0) {  // Calculate every minInterval ms
         float flowRate = (pulseCount / calibrationFactor) / (elapsedTime / 1000.0);
         lastTime = currentTime;
         pulseCount = 0;
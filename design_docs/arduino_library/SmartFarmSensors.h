@@ -97,7 +97,7 @@ public:
     FlowRateSensor(uint8_t interruptPin, float factor = 7.5);
     void begin();
     void pulseCounter();  // ISR function
-    float readFlowRate();  // L/min
+    float readFlowRate(unsigned long minInterval = 1000);  // L/min, 0 until minInterval ms have passed
     float getTotalLiters();
     void reset();
     
@@ -0,0 +1,187 @@
+/*
+ * SmartFarm Streaming Statistics - Implementation
+ * Version: 1.0.0
+ */
+
+#include "SmartFarmStats.h"
+#include <math.h>
+
+#define STATS_QUANTILE 0.95f
+
+StreamingStats::StreamingStats() {
+    reset();
+}
+
+void StreamingStats::reset() {
+    count = 0;
+    rejected = 0;
+    minValue = 0;
+    maxValue = 0;
+    mean = 0;
+    m2 = 0;
+    integral = 0;
+    lastValue = 0;
+    hasLast = false;
+    skippedSeconds = 0;
+    carriedSeconds = 0;
+    for (int i = 0; i < 5; i++) {
+        heights[i] = 0;
+        positions[i] = i + 1;
+    }
+    desired[0] = 1;
+    desired[1] = 1 + 2 * STATS_QUANTILE;
+    desired[2] = 1 + 4 * STATS_QUANTILE;
+    desired[3] = 3 + 2 * STATS_QUANTILE;
+    desired[4] = 5;
+}
+
+void StreamingStats::startWindow(float dtSeconds) {
+    float last = lastValue;
+    bool had = hasLast;
+    reset();
+
+    if (had) {
+        lastValue = last;
+        hasLast = true;
+        carriedSeconds = dtSeconds;
+    }
+}
+
+bool StreamingStats::add(float value, float dtSeconds) {
+    // After startWindow(), only the time since the boundary is ours
+    float gap = dtSeconds > carriedSeconds ? dtSeconds - carriedSeconds : 0;
+    carriedSeconds = 0;
+
+    if (isnan(value) || isinf(value) || value == SENSOR_ERROR_VALUE) {
+        rejected++;
+        skippedSeconds += gap;
+        return false;
+    }
+
+    if (count == 0) {
+        minValue = value;
+        maxValue = value;
+    } else {
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+    if (hasLast) {
+        // Across rejected samples: one trapezoid from the last good value
+        integral += 0.5 * (value + lastValue) * (gap + skippedSeconds);
+    }
+    skippedSeconds = 0;
+    lastValue = value;
+    hasLast = true;
+
+    count++;
+    float delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+
+    updateQuantile(value);
+    return true;
+}
+
+// P-square algorithm (Jain & Chlamtac, 1985): five markers track the
+// min, p/2, p, (1+p)/2 and max quantiles without storing samples
+void StreamingStats::updateQuantile(float value) {
+    // First five samples: keep them sorted as the initial markers
+    if (count <= 5) {
+        int i = count - 1;
+        while (i > 0 && heights[i - 1] > value) {
+            heights[i] = heights[i - 1];
+            i--;
+        }
+        heights[i] = value;
+        return;
+    }
+
+    // Find the cell containing the sample, extending the extremes if needed
+    int k;
+    if (value < heights[0]) {
+        heights[0] = value;
+        k = 0;
+    } else if (value >= heights[4]) {
+        heights[4] = value;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && value >= heights[k + 1]) {
+            k++;
+        }
+    }
+
+    for (int i = k + 1; i < 5; i++) {
+        positions[i] += 1;
+    }
+    desired[1] += STATS_QUANTILE / 2;
+    desired[2] += STATS_QUANTILE;
+    desired[3] += (1 + STATS_QUANTILE) / 2;
+    desired[4] += 1;
+
+    // Move the middle markers towards their desired positions
+    for (int i = 1; i <= 3; i++) {
+        float d = desired[i] - positions[i];
+        if ((d >= 1 && positions[i + 1] - positions[i] > 1) ||
+            (d <= -1 && positions[i - 1] - positions[i] < -1)) {
+            float s = d >= 0 ? 1 : -1;
+
+            // Piecewise-parabolic prediction
+            float q = heights[i] + s / (positions[i + 1] - positions[i - 1]) *
+                ((positions[i] - positions[i - 1] + s) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i]) +
+                 (positions[i + 1] - positions[i] - s) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+
+            if (q <= heights[i - 1] || q >= heights[i + 1]) {
+                // Fall back to linear when the parabola overshoots a neighbour
+                int j = i + (int)s;
+                q = heights[i] + s * (heights[j] - heights[i]) / (positions[j] - positions[i]);
+            }
+
+            heights[i] = q;
+            positions[i] += s;
+        }
+    }
+}
+
+uint32_t StreamingStats::getCount() const {
+    return count;
+}
+
+uint32_t StreamingStats::getRejected() const {
+    return rejected;
+}
+
+float StreamingStats::getMin() const {
+    return minValue;
+}
+
+float StreamingStats::getMax() const {
+    return maxValue;
+}
+
+float StreamingStats::getMean() const {
+    return mean;
+}
+
+float StreamingStats::getStdDev() const {
+    return count > 1 ? sqrtf(m2 / (count - 1)) : 0;
+}
+
+float StreamingStats::getP95() const {
+    if (count == 0) {
+        return 0;
+    }
+    if (count <= 5) {
+        // Nearest rank over the few samples seen so far
+        int rank = (int)ceilf(STATS_QUANTILE * count) - 1;
+        return heights[rank < 0 ? 0 : rank];
+    }
+    return heights[2];
+}
+
+double StreamingStats::getIntegral(float heldSeconds) const {
+    if (!hasLast) {
+        return integral;
+    }
+    return integral + (double)lastValue * (skippedSeconds + heldSeconds);
+}
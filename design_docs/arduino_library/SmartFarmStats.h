@@ -0,0 +1,71 @@
+/*
+ * SmartFarm Streaming Statistics
+ * Version: 1.0.0
+ *
+ * O(1) memory summary of a stream of samples: min, max, mean, stddev,
+ * approximate 95th percentile (P-square estimator) and the time integral
+ * (e.g. energy from power). Plain C++ with no Arduino dependency, so it
+ * also builds on the host. Failed reads (NaN, infinity, SENSOR_ERROR_VALUE)
+ * are counted and left out of every statistic.
+ */
+
+#ifndef SMARTFARM_STATS_H
+#define SMARTFARM_STATS_H
+
+#include <stdint.h>
+
+// Returned by TemperatureHumiditySensor when a read fails
+#ifndef SENSOR_ERROR_VALUE
+#define SENSOR_ERROR_VALUE -999.0f
+#endif
+
+class StreamingStats {
+private:
+    uint32_t count;
+    uint32_t rejected;  // Failed reads left out
+    float minValue;
+    float maxValue;
+    float mean;        // Welford running mean
+    float m2;          // Welford sum of squared deviations
+    double integral;   // Sum of value * seconds (trapezoid rule)
+    float lastValue;
+    bool hasLast;          // lastValue is set (kept by startWindow())
+    float skippedSeconds;  // Time since lastValue covered by rejected samples
+    float carriedSeconds;  // Part of the next gap already counted by the previous window
+
+    // P-square markers for the 95th percentile
+    float heights[5];
+    float positions[5];
+    float desired[5];
+
+    void updateQuantile(float value);
+
+public:
+    StreamingStats();
+
+    // Forget everything, including the last value
+    void reset();
+
+    // Start the next window dtSeconds after the last sample. The last value is
+    // kept, so the trapezoid across the boundary is split between the windows:
+    // the closing one holds the last value up to the boundary (see
+    // getIntegral()), the new one integrates from the boundary on.
+    void startWindow(float dtSeconds);
+
+    // Add a sample; dtSeconds is the time since the previous sample (0 for the first).
+    // Returns false for a failed read; its dt is carried over to the next sample.
+    bool add(float value, float dtSeconds = 0);
+
+    uint32_t getCount() const;
+    uint32_t getRejected() const;
+    float getMin() const;
+    float getMax() const;
+    float getMean() const;
+    float getStdDev() const;
+    float getP95() const;
+    // value-seconds (W -> J). The last good value is held over failed reads
+    // since, and for heldSeconds after the last sample.
+    double getIntegral(float heldSeconds = 0) const;
+};
+
+#endif // SMARTFARM_STATS_H
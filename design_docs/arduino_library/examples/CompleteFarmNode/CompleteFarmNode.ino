@@ -10,6 +10,7 @@
  * - Ultrasonic (Water Level) → Trig: 5, Echo: 18
  * - Flow Sensor → Pin 2
  * - Voltage Sensor (Battery) → Pin 33
+ * - ACS712 Current Sensor (Pump, 12V) → Pin 36
  * - Relay (Pump) → Pin 25
  * 
  * This example demonstrates the STANDARD way to read all sensors
@@ -18,6 +19,7 @@
 
 #include <SmartFarmIoT.h>
 #include <SmartFarmSensors.h>
+#include <SmartFarmAggregator.h>
 
 // ==================== DEVICE CREDENTIALS ====================
 const char* DEVICE_ID = "FARM_NODE_001";
@@ -25,6 +27,8 @@ const char* DEVICE_TOKEN = "your-device-token-here";
 const char* WIFI_SSID = "YourWiFi";
 const char* WIFI_PASSWORD = "YourPassword";
 const char* MQTT_SERVER = "192.168.1.100";
+const char* FARM_ID = "your-farm-id-here";      // For farm-wide commands
+const char* COMMAND_GROUP = "zone_a_pumps";     // For group commands
 
 // ==================== SENSOR PINS ====================
 #define DHT_PIN 4
@@ -35,6 +39,7 @@ const char* MQTT_SERVER = "192.168.1.100";
 #define ECHO_PIN 18
 #define FLOW_PIN 2
 #define VOLTAGE_PIN 33
+#define CURRENT_PIN 36
 #define RELAY_PIN 25
 
 // ==================== SENSOR INSTANCES ====================
@@ -56,11 +61,24 @@ FlowRateSensor flowRate(FLOW_PIN, 7.5);  // YF-S201 sensor
 
 // Power Monitoring
 VoltageSensor battery(VOLTAGE_PIN, 0.5, 3.3);  // Voltage divider 1:1
+CurrentSensor pumpCurrent(CURRENT_PIN, 185, 5.0);  // ACS712 5A
+
+// High-rate sampling between publishes (catches pump spikes & flow transients)
+SensorAggregator aggregator;
+const float PUMP_VOLTAGE = 12.0;
+
+float readPumpPower() { return pumpCurrent.readPower(PUMP_VOLTAGE); }
+float readFlow() { return flowRate.readFlowRate(100); }
 
 // ==================== TIMING ====================
 unsigned long lastSendTime = 0;
 const unsigned long SEND_INTERVAL = 5000;  // 5 seconds
 
+// Pump timer, checked from loop() so the aggregator keeps sampling while the pump runs
+unsigned long pumpStartTime = 0;
+unsigned long pumpDuration = 0;      // ms, 0 = no timed run
+const char* pumpReason = nullptr;    // Reported when an automatic run ends
+
 // ==================== SETUP ====================
 void setup() {
     Serial.begin(115200);
@@ -72,6 +90,8 @@ void setup() {
     soilMoisture.calibrate(4095, 1500);  // Calibrate for your soil
     waterLevel.readDistance();  // First read to initialize
     flowRate.begin();
+    aggregator.addChannel("pump_power", readPumpPower, 100, true);  // 100 Hz, energy in Wh
+    aggregator.addChannel("flow_rate", readFlow, 10);               // 10 Hz
     
     // Initialize relay
     pinMode(RELAY_PIN, OUTPUT);
@@ -81,6 +101,8 @@ void setup() {
     Serial.println("🌐 Connecting to Smart Farm Platform...");
     iot.begin(WIFI_SSID, WIFI_PASSWORD, MQTT_SERVER);
     iot.onCommand(handleCommand);
+    iot.setFarmId(FARM_ID);
+    iot.joinGroup(COMMAND_GROUP);
     
     Serial.println("✅ Smart Farm Node Ready!");
     Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -89,6 +111,8 @@ void setup() {
 // ==================== MAIN LOOP ====================
 void loop() {
     iot.loop();
+    aggregator.loop();
+    updatePump();
     
     if (millis() - lastSendTime >= SEND_INTERVAL) {
         readAndSendAllSensors();
@@ -143,12 +167,12 @@ void readAndSendAllSensors() {
     sensors["water_level"] = waterLevelCm;
     Serial.printf("  💦 Water Level: %.1f cm (%d%%)\n", waterLevelCm, waterLevelPercent);
     
-    // 5. FLOW RATE
-    float flow = flowRate.readFlowRate();
-    if (flow > 0) {
-        sensors["flow_rate"] = flow;
-        Serial.printf("  🚰 Flow Rate: %.2f L/min\n", flow);
-    }
+    // 5. FLOW RATE & PUMP POWER (window summaries instead of single readings)
+    StaticJsonDocument<MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE> stats;
+    aggregator.writeSummary(sensors.as<JsonObject>(), stats.to<JsonObject>());
+    aggregator.reset();
+    Serial.printf("  🚰 Flow Rate: %.2f L/min (avg)\n", sensors["flow_rate"] | 0.0f);
+    Serial.printf("  ⚡ Pump Power: %.1f W (avg)\n", sensors["pump_power"] | 0.0f);
     
     // 6. BATTERY VOLTAGE
     float batteryVoltage = battery.readVoltage();
@@ -156,7 +180,7 @@ void readAndSendAllSensors() {
     Serial.printf("  🔋 Battery: %.2fV (%d%%)\n", batteryVoltage, batteryPercent);
     
     // 7. SEND TO PLATFORM
-    bool success = iot.sendTelemetry(sensors.as<JsonObject>(), batteryVoltage);
+    bool success = iot.sendTelemetry(sensors.as<JsonObject>(), stats.as<JsonObject>(), batteryVoltage);
     
     if (success) {
         Serial.println("✅ Data sent successfully!");
@@ -177,26 +201,55 @@ void checkAutoIrrigation(int soilMoisture, int waterLevel) {
     // 2. Water tank has enough water (> 20%)
     
     if (soilMoisture < 30 && waterLevel > 20) {
+        if (pumpDuration > 0) {
+            return;  // Already watering
+        }
         Serial.println("🚨 Soil too dry! Starting irrigation...");
-        digitalWrite(RELAY_PIN, HIGH);
-        
-        // Water for 10 seconds
-        delay(10000);
         
-        digitalWrite(RELAY_PIN, LOW);
+        // Water for 10 seconds (switched off by updatePump())
+        startPump(10, "low_soil_moisture");
+    }
+    else if (soilMoisture < 30 && waterLevel <= 20) {
+        Serial.println("⚠️  Soil dry but water level too low!");
+        // TODO: Send alert to platform
+    }
+}
+
+// ==================== PUMP TIMER ====================
+void startPump(unsigned long seconds, const char* reason) {
+    digitalWrite(RELAY_PIN, HIGH);
+    pumpStartTime = millis();
+    pumpDuration = seconds * 1000;
+    pumpReason = reason;
+}
+
+void stopPump() {
+    digitalWrite(RELAY_PIN, LOW);
+    pumpDuration = 0;
+}
+
+// A delay() here would stop aggregator.loop() for the whole run,
+// missing the pump current spikes the aggregator is there to catch
+void updatePump() {
+    if (pumpDuration == 0 || millis() - pumpStartTime < pumpDuration) {
+        return;
+    }
+    
+    unsigned long seconds = pumpDuration / 1000;
+    const char* reason = pumpReason;
+    stopPump();
+    Serial.printf("🛑 Pump turned OFF after %lu seconds\n", seconds);
+    
+    if (reason) {
         Serial.println("✅ Irrigation complete");
         
         // Send status update
         StaticJsonDocument<128> status;
         status["action"] = "irrigation";
-        status["duration"] = 10;
-        status["reason"] = "low_soil_moisture";
+        status["duration"] = seconds;
+        status["reason"] = reason;
         iot.sendTelemetry(status.as<JsonObject>());
     }
-    else if (soilMoisture < 30 && waterLevel <= 20) {
-        Serial.println("⚠️  Soil dry but water level too low!");
-        // TODO: Send alert to platform
-    }
 }
 
 // ==================== COMMAND HANDLER ====================
@@ -208,41 +261,41 @@ void handleCommand(String command, JsonObject params) {
         int duration = params["duration"] | 0;
         
         if (state == "ON") {
-            digitalWrite(RELAY_PIN, HIGH);
-            Serial.println("💧 Pump turned ON");
-            
             if (duration > 0) {
-                delay(duration * 1000);
-                digitalWrite(RELAY_PIN, LOW);
-                Serial.printf("🛑 Pump turned OFF after %d seconds\n", duration);
+                startPump(duration, nullptr);  // Turned off by updatePump()
+            } else {
+                digitalWrite(RELAY_PIN, HIGH);
+                pumpDuration = 0;
             }
+            Serial.println("💧 Pump turned ON");
             
-            iot.sendCommandResponse(params["request_id"] | "unknown", true, "Pump ON");
+            iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Pump ON");
         } else {
-            digitalWrite(RELAY_PIN, LOW);
+            stopPump();
             Serial.println("🛑 Pump turned OFF");
-            iot.sendCommandResponse(params["request_id"] | "unknown", true, "Pump OFF");
+            iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Pump OFF");
         }
     }
     else if (command == "read_sensors") {
         Serial.println("📊 Reading sensors on demand...");
         readAndSendAllSensors();
-        iot.sendCommandResponse(params["request_id"] | "unknown", true, "Sensors read");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Sensors read");
     }
     else if (command == "calibrate_soil") {
         int dryValue = params["dry"] | 4095;
         int wetValue = params["wet"] | 1500;
         soilMoisture.calibrate(dryValue, wetValue);
         Serial.printf("🔧 Soil sensor calibrated: Dry=%d, Wet=%d\n", dryValue, wetValue);
-        iot.sendCommandResponse(params["request_id"] | "unknown", true, "Calibrated");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Calibrated");
     }
     else if (command == "restart") {
-        iot.sendCommandResponse(params["request_id"] | "unknown", true, "Restarting...");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Restarting...");
+        iot.flushResponses();  // Farm/group commands are answered after a delay
         delay(1000);
         ESP.restart();
     }
     else {
         Serial.println("❌ Unknown command");
-        iot.sendCommandResponse(params["request_id"] | "unknown", false, "Unknown command");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), false, "Unknown command");
     }
 }
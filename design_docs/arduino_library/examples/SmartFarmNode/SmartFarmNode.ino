@@ -111,25 +111,26 @@ void handleCommand(String command, JsonObject params) {
                     Serial.println("🛑 Pump OFF (timeout)");
                 }
                 
-                iot.sendCommandResponse(params["request_id"] | "unknown", true, "Relay turned ON");
+                iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Relay turned ON");
             } else {
                 digitalWrite(RELAY_PIN, LOW);
                 Serial.println("🛑 Pump OFF");
-                iot.sendCommandResponse(params["request_id"] | "unknown", true, "Relay turned OFF");
+                iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Relay turned OFF");
             }
         }
     }
     else if (command == "restart") {
-        iot.sendCommandResponse(params["request_id"] | "unknown", true, "Restarting...");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Restarting...");
+        iot.flushResponses();  // Farm/group commands are answered after a delay
         delay(1000);
         ESP.restart();
     }
     else if (command == "update_interval") {
         int interval = params["interval"] | 5;
         iot.setSendInterval(interval * 1000);
-        iot.sendCommandResponse(params["request_id"] | "unknown", true, "Interval updated");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), true, "Interval updated");
     }
     else {
-        iot.sendCommandResponse(params["request_id"] | "unknown", false, "Unknown command");
+        iot.sendCommandResponse(iot.getCurrentRequestId().c_str(), false, "Unknown command");
     }
 }
@@ -0,0 +1,245 @@
+/*
+ * SmartFarm Edge Hub - Device Shadow Implementation
+ * Version: 1.0.0
+ */
+
+#include "DeviceShadow.h"
+
+#include <cstring>
+
+// Copy and always terminate (fields are fixed-size)
+template <size_t N>
+static void copyString(char (&dest)[N], const char* src) {
+    if (!src) {
+        dest[0] = '\0';
+        return;
+    }
+    strncpy(dest, src, N - 1);
+    dest[N - 1] = '\0';
+}
+
+DeviceShadow::DeviceShadow(size_t capacity) {
+    size_t size = 16;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    _hashes.reset(new std::atomic<uint64_t>[size]);
+    _slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        _hashes[i].store(0, std::memory_order_relaxed);
+        _slots[i].seq.store(0, std::memory_order_relaxed);
+    }
+
+    _mask = size - 1;
+    _count = 0;
+    _heartbeatTimeout = DEFAULT_HEARTBEAT_TIMEOUT;
+}
+
+void DeviceShadow::setHeartbeatTimeout(int64_t seconds) {
+    _heartbeatTimeout = seconds;
+}
+
+// FNV-1a 64 (0 is reserved for empty entries)
+uint64_t DeviceShadow::hashKey(const char* deviceId) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* p = deviceId; *p; p++) {
+        hash ^= (uint8_t)*p;
+        hash *= 1099511628211ull;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+DeviceShadow::Slot* DeviceShadow::find(const char* deviceId, uint64_t hash) const {
+    for (size_t i = 0; i <= _mask; i++) {
+        size_t index = (hash + i) & _mask;
+        uint64_t stored = _hashes[index].load(std::memory_order_acquire);
+        if (stored == 0) {
+            return nullptr;  // Empty entry ends the probe chain (no deletions)
+        }
+        // deviceId is never written after publication, so it can be compared during updates
+        if (stored == hash && strcmp(_slots[index].state.deviceId, deviceId) == 0) {
+            return &_slots[index];
+        }
+    }
+    return nullptr;
+}
+
+DeviceShadow::Slot* DeviceShadow::findOrInsert(const char* deviceId) {
+    uint64_t hash = hashKey(deviceId);
+    Slot* slot = find(deviceId, hash);
+    if (slot) {
+        return slot;
+    }
+
+    // Keep the load factor below 7/8 so probe chains stay short
+    size_t count = _count.load(std::memory_order_relaxed);
+    if (count + 1 > (_mask + 1) - ((_mask + 1) >> 3)) {
+        return nullptr;
+    }
+
+    for (size_t i = 0; i <= _mask; i++) {
+        size_t index = (hash + i) & _mask;
+        if (_hashes[index].load(std::memory_order_relaxed) == 0) {
+            slot = &_slots[index];
+            memset(&slot->state, 0, sizeof(slot->state));
+            copyString(slot->state.deviceId, deviceId);
+            copyString(slot->state.status, "offline");
+            _hashes[index].store(hash, std::memory_order_release);
+            _count.store(count + 1, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+void DeviceShadow::beginWrite(Slot* slot) {
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void DeviceShadow::endWrite(Slot* slot) {
+    uint32_t seq = slot->seq.load(std::memory_order_relaxed);
+    slot->seq.store(seq + 1, std::memory_order_release);
+}
+
+bool DeviceShadow::updateTelemetry(const char* deviceId, int64_t timestamp,
+                                   const ShadowSensor* sensors, size_t count,
+                                   float batteryVoltage, int16_t rssi) {
+    Slot* slot = findOrInsert(deviceId);
+    if (!slot) {
+        return false;
+    }
+
+    beginWrite(slot);
+    DeviceShadowState& state = slot->state;
+
+    for (size_t i = 0; i < count; i++) {
+        uint8_t j = 0;
+        while (j < state.sensorCount && strcmp(state.sensors[j].name, sensors[i].name) != 0) {
+            j++;
+        }
+        if (j == state.sensorCount) {
+            if (state.sensorCount == SHADOW_MAX_SENSORS) {
+                continue;
+            }
+            copyString(state.sensors[j].name, sensors[i].name);
+            state.sensorCount++;
+        }
+        state.sensors[j].value = sensors[i].value;
+    }
+
+    // Telemetry implies the device is up (same as /api/telemetry)
+    copyString(state.status, "online");
+    state.telemetryTime = timestamp;
+    if (batteryVoltage > 0) {
+        state.batteryVoltage = batteryVoltage;
+    }
+    if (rssi != 0) {
+        state.rssi = rssi;
+    }
+    if (timestamp > state.lastSeen) {
+        state.lastSeen = timestamp;
+    }
+
+    endWrite(slot);
+    return true;
+}
+
+bool DeviceShadow::updateStatus(const char* deviceId, const char* status, uint32_t uptime,
+                                const char* firmwareVersion, int64_t timestamp) {
+    Slot* slot = findOrInsert(deviceId);
+    if (!slot) {
+        return false;
+    }
+
+    beginWrite(slot);
+    DeviceShadowState& state = slot->state;
+    copyString(state.status, status);
+    state.uptime = uptime;
+    if (firmwareVersion) {
+        copyString(state.firmwareVersion, firmwareVersion);
+    }
+    if (timestamp > state.lastSeen) {
+        state.lastSeen = timestamp;
+    }
+    endWrite(slot);
+    return true;
+}
+
+bool DeviceShadow::commandSent(const char* deviceId, const char* requestId,
+                               const char* command, int64_t timestamp) {
+    Slot* slot = findOrInsert(deviceId);
+    if (!slot) {
+        return false;
+    }
+
+    beginWrite(slot);
+    DeviceShadowState& state = slot->state;
+    copyString(state.commandRequestId, requestId);
+    copyString(state.command, command);
+    state.commandSentAt = timestamp;
+    state.commandAnsweredAt = 0;
+    state.commandState = COMMAND_PENDING;
+    endWrite(slot);
+    return true;
+}
+
+bool DeviceShadow::commandResponse(const char* deviceId, const char* requestId,
+                                   bool success, int64_t timestamp) {
+    Slot* slot = find(deviceId, hashKey(deviceId));
+    if (!slot) {
+        return false;
+    }
+
+    beginWrite(slot);
+    DeviceShadowState& state = slot->state;
+    bool matches = strcmp(state.commandRequestId, requestId) == 0;
+    if (matches) {
+        state.commandAnsweredAt = timestamp;
+        state.commandState = success ? COMMAND_SUCCESS : COMMAND_ERROR;
+    }
+    if (timestamp > state.lastSeen) {
+        state.lastSeen = timestamp;
+    }
+    endWrite(slot);
+    return matches;
+}
+
+bool DeviceShadow::read(const char* deviceId, DeviceShadowState& out) const {
+    Slot* slot = find(deviceId, hashKey(deviceId));
+    if (!slot) {
+        return false;
+    }
+
+    // Retry until the copy didn't overlap a write
+    while (true) {
+        uint32_t before = slot->seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        memcpy(&out, &slot->state, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot->seq.load(std::memory_order_relaxed) == before) {
+            return true;
+        }
+    }
+}
+
+bool DeviceShadow::isOnline(const DeviceShadowState& state, int64_t now) const {
+    if (strcmp(state.status, "offline") == 0) {
+        return false;
+    }
+    return state.lastSeen > 0 && now - state.lastSeen <= _heartbeatTimeout;
+}
+
+size_t DeviceShadow::size() const {
+    return _count.load(std::memory_order_relaxed);
+}
+
+size_t DeviceShadow::capacity() const {
+    return _mask + 1;
+}
@@ -0,0 +1,118 @@
+/*
+ * SmartFarm Edge Hub - Device Shadow
+ * Version: 1.0.0
+ *
+ * Latest known state of every device (sensor values, reported status,
+ * liveness, pending command) kept in memory so dashboards don't have to
+ * query the newest telemetry rows.
+ *
+ * - One ingest thread writes, any number of threads read
+ * - Open addressing (linear probing) over a dense array of hashes; the
+ *   state of each device lives in a separate cache-line aligned slot
+ * - Readers take consistent snapshots through a per-slot seqlock and never block the writer
+ * - Devices are never removed, so a published slot key never changes
+ */
+
+#ifndef DEVICE_SHADOW_H
+#define DEVICE_SHADOW_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#define SHADOW_MAX_SENSORS 12
+#define DEFAULT_SHADOW_CAPACITY 16384     // Slots (rounded up to a power of two)
+#define DEFAULT_HEARTBEAT_TIMEOUT 30      // Seconds without a message before a device is offline
+
+enum ShadowCommandState : uint8_t {
+    COMMAND_NONE = 0,
+    COMMAND_PENDING,
+    COMMAND_SUCCESS,
+    COMMAND_ERROR
+};
+
+struct ShadowSensor {
+    char name[24];
+    double value;
+};
+
+struct DeviceShadowState {
+    char deviceId[40];
+
+    // Latest telemetry (one value per sensor)
+    int64_t telemetryTime;   // Unix epoch of last telemetry message
+    float batteryVoltage;
+    int16_t rssi;
+    uint8_t sensorCount;
+    ShadowSensor sensors[SHADOW_MAX_SENSORS];
+
+    // Reported status (farm/{device_id}/status)
+    char status[12];         // "online", "offline", "error"
+    uint32_t uptime;
+    char firmwareVersion[16];
+
+    // Liveness: any message from the device counts as a heartbeat
+    int64_t lastSeen;
+
+    // Last command sent to the device and its outcome
+    char commandRequestId[40];
+    char command[24];
+    int64_t commandSentAt;
+    int64_t commandAnsweredAt;
+    ShadowCommandState commandState;
+};
+
+class DeviceShadow {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> seq;   // Odd while the writer is updating
+        DeviceShadowState state;     // state.deviceId is the key
+    };
+
+    // Probe index, parallel to _slots: 8 hashes per cache line, so probing
+    // doesn't touch the 576-byte slots until the hash matches.
+    // 0 = empty; a hash is published only after its slot is initialized.
+    std::unique_ptr<std::atomic<uint64_t>[]> _hashes;
+    std::unique_ptr<Slot[]> _slots;
+    size_t _mask;
+    std::atomic<size_t> _count;
+    int64_t _heartbeatTimeout;
+
+    static uint64_t hashKey(const char* deviceId);
+    Slot* find(const char* deviceId, uint64_t hash) const;
+    Slot* findOrInsert(const char* deviceId);
+    static void beginWrite(Slot* slot);
+    static void endWrite(Slot* slot);
+
+public:
+    explicit DeviceShadow(size_t capacity = DEFAULT_SHADOW_CAPACITY);
+
+    void setHeartbeatTimeout(int64_t seconds);
+
+    // ---- Writer (single ingest thread) ----
+
+    // Merge sensor values into the shadow; false if the table is full
+    bool updateTelemetry(const char* deviceId, int64_t timestamp,
+                         const ShadowSensor* sensors, size_t count,
+                         float batteryVoltage = 0, int16_t rssi = 0);
+    bool updateStatus(const char* deviceId, const char* status, uint32_t uptime,
+                      const char* firmwareVersion, int64_t timestamp);
+    bool commandSent(const char* deviceId, const char* requestId,
+                     const char* command, int64_t timestamp);
+    bool commandResponse(const char* deviceId, const char* requestId,
+                         bool success, int64_t timestamp);
+
+    // ---- Readers (any thread, lock-free) ----
+
+    // Copy a consistent snapshot; false if the device is unknown
+    bool read(const char* deviceId, DeviceShadowState& out) const;
+
+    // Online = last message within the heartbeat timeout and not reported offline
+    bool isOnline(const DeviceShadowState& state, int64_t now) const;
+
+    size_t size() const;
+    size_t capacity() const;
+};
+
+#endif // DEVICE_SHADOW_H
@@ -0,0 +1,306 @@
+/*
+ * SmartFarm Edge Hub - PostgreSQL Upload Sink Implementation
+ * Version: 1.0.0
+ */
+
+#include "PostgresSink.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#define COPY_CHUNK_SIZE 65536
+
+// Escape a value for COPY ... FROM STDIN text format
+static void appendCopyText(std::string& out, const char* value) {
+    for (const char* p = value; *p; p++) {
+        switch (*p) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out += *p;
+        }
+    }
+}
+
+// Quote an element of a PostgreSQL array literal
+static void appendArrayElement(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+// Same metadata shape as /api/telemetry
+static void appendMetadata(std::string& out, const TelemetryRecord& record) {
+    char buf[128];
+    out += '{';
+    bool first = true;
+
+    if (record.batteryVoltage > 0) {
+        snprintf(buf, sizeof(buf), "\"battery_voltage\":%.3g", record.batteryVoltage);
+        out += buf;
+        first = false;
+    }
+    if (record.rssi != 0) {
+        snprintf(buf, sizeof(buf), "%s\"rssi\":%d", first ? "" : ",", record.rssi);
+        out += buf;
+        first = false;
+    }
+    if (record.protocolVersion[0]) {
+        snprintf(buf, sizeof(buf), "%s\"protocol_version\":\"%.*s\"", first ? "" : ",",
+                 (int)sizeof(record.protocolVersion), record.protocolVersion);
+        out += buf;
+    }
+    out += '}';
+}
+
+PostgresSink::PostgresSink(const std::string& conninfo, const std::string& uploaderId)
+    : _conninfo(conninfo), _uploaderId(uploaderId) {
+    _conn = nullptr;
+}
+
+PostgresSink::~PostgresSink() {
+    if (_conn) {
+        PQfinish(_conn);
+    }
+}
+
+bool PostgresSink::ensureConnected() {
+    if (_conn && PQstatus(_conn) == CONNECTION_OK) {
+        return true;
+    }
+
+    if (_conn) {
+        PQfinish(_conn);
+    }
+    _conn = PQconnectdb(_conninfo.c_str());
+
+    if (PQstatus(_conn) != CONNECTION_OK) {
+        fail("connect");
+        PQfinish(_conn);
+        _conn = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void PostgresSink::fail(const char* context, const PGresult* res) {
+    _lastError = std::string(context) + ": " + (_conn ? PQerrorMessage(_conn) : "no connection");
+    const char* sqlState = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+    _lastSqlState = sqlState ? sqlState : "";
+}
+
+bool PostgresSink::exec(const char* sql) {
+    PGresult* res = PQexec(_conn, sql);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        fail(sql, res);
+    }
+    PQclear(res);
+    return ok;
+}
+
+// Roll back after a failed statement. Integrity constraint violations (class
+// 23, e.g. the device was deleted) and data exceptions (class 22) fail the
+// same way on every retry; anything else (connection, lock, timeout) may not.
+WriteStatus PostgresSink::rollback() {
+    std::string sqlState = _lastSqlState;
+    std::string error = _lastError;
+    exec("ROLLBACK");
+    _lastSqlState = sqlState;
+    _lastError = error;
+
+    bool permanent = sqlState.compare(0, 2, "23") == 0 || sqlState.compare(0, 2, "22") == 0;
+    return permanent ? WRITE_REJECTED : WRITE_RETRY;
+}
+
+bool PostgresSink::lookupFarms(const std::vector<std::string>& deviceIds,
+                               std::map<std::string, std::string>& farmIds) {
+    if (!ensureConnected()) {
+        return false;
+    }
+
+    std::string ids = "{";
+    for (size_t i = 0; i < deviceIds.size(); i++) {
+        if (i > 0) {
+            ids += ',';
+        }
+        appendArrayElement(ids, deviceIds[i]);
+    }
+    ids += '}';
+
+    const char* params[1] = { ids.c_str() };
+    PGresult* res = PQexecParams(_conn,
+        "SELECT id::text, farm_id::text FROM devices WHERE id::text = ANY($1::text[])",
+        1, nullptr, params, nullptr, nullptr, 0);
+
+    if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+        fail("lookupFarms", res);
+        PQclear(res);
+        return false;
+    }
+
+    for (int row = 0; row < PQntuples(res); row++) {
+        if (!PQgetisnull(res, row, 1)) {
+            farmIds[PQgetvalue(res, row, 0)] = PQgetvalue(res, row, 1);
+        }
+    }
+    PQclear(res);
+    return true;
+}
+
+WriteStatus PostgresSink::writeBatch(const std::vector<WalEntry>& rows,
+                                     const std::map<std::string, int64_t>& lastSeen,
+                                     uint64_t lastSeq) {
+    if (!ensureConnected()) {
+        return WRITE_RETRY;
+    }
+
+    if (!exec("BEGIN")) {
+        return WRITE_RETRY;
+    }
+
+    // 1. Telemetry rows via COPY (one round-trip for the whole batch)
+    if (!rows.empty()) {
+        PGresult* res = PQexec(_conn,
+            "COPY telemetry (time, device_id, sensor_type, value, metadata) FROM STDIN");
+        bool ok = PQresultStatus(res) == PGRES_COPY_IN;
+        PQclear(res);
+
+        std::string chunk;
+        chunk.reserve(COPY_CHUNK_SIZE + 512);
+
+        for (size_t i = 0; ok && i < rows.size(); i++) {
+            const TelemetryRecord& record = rows[i].record;
+            char buf[64];
+
+            // Ingest time; like /api/telemetry, the device timestamp isn't stored
+            time_t seconds = (time_t)record.receivedAt;
+            struct tm utc;
+            gmtime_r(&seconds, &utc);
+            strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S+00\t", &utc);
+            chunk += buf;
+
+            appendCopyText(chunk, record.deviceId);
+            chunk += '\t';
+            appendCopyText(chunk, record.sensorType);
+            snprintf(buf, sizeof(buf), "\t%.10g\t", record.value);
+            chunk += buf;
+
+            std::string metadata;
+            appendMetadata(metadata, record);
+            appendCopyText(chunk, metadata.c_str());
+            chunk += '\n';
+
+            if (chunk.size() >= COPY_CHUNK_SIZE || i + 1 == rows.size()) {
+                ok = PQputCopyData(_conn, chunk.data(), (int)chunk.size()) == 1;
+                chunk.clear();
+            }
+        }
+
+        if (PQputCopyEnd(_conn, ok ? nullptr : "uploader aborted") != 1) {
+            ok = false;
+        }
+        res = PQgetResult(_conn);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            ok = false;
+        }
+        if (!ok) {
+            fail("COPY telemetry", res);
+        }
+        PQclear(res);
+        while ((res = PQgetResult(_conn)) != nullptr) {
+            PQclear(res);
+        }
+
+        if (!ok) {
+            return rollback();
+        }
+    }
+
+    // 2. One coalesced last_seen update per device
+    if (!lastSeen.empty()) {
+        std::string ids = "{";
+        std::string seen = "{";
+        for (auto it = lastSeen.begin(); it != lastSeen.end(); ++it) {
+            if (it != lastSeen.begin()) {
+                ids += ',';
+                seen += ',';
+            }
+            appendArrayElement(ids, it->first);
+            seen += std::to_string(it->second);
+        }
+        ids += '}';
+        seen += '}';
+
+        const char* params[2] = { ids.c_str(), seen.c_str() };
+        PGresult* res = PQexecParams(_conn,
+            "UPDATE devices d SET status = 'online', last_seen = to_timestamp(v.seen) "
+            "FROM unnest($1::text[], $2::bigint[]) AS v(id, seen) "
+            "WHERE d.id::text = v.id AND (d.last_seen IS NULL OR d.last_seen < to_timestamp(v.seen))",
+            2, nullptr, params, nullptr, nullptr, 0);
+        bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+        if (!ok) {
+            fail("UPDATE devices", res);
+        }
+        PQclear(res);
+
+        if (!ok) {
+            return rollback();
+        }
+    }
+
+    // 3. Watermark in the same transaction makes crash recovery exact
+    std::string seq = std::to_string(lastSeq);
+    const char* params[2] = { _uploaderId.c_str(), seq.c_str() };
+    PGresult* res = PQexecParams(_conn,
+        "INSERT INTO iot_uploader_progress (uploader_id, last_seq, updated_at) "
+        "VALUES ($1, $2::bigint, NOW()) "
+        "ON CONFLICT (uploader_id) DO UPDATE SET last_seq = EXCLUDED.last_seq, updated_at = NOW()",
+        2, nullptr, params, nullptr, nullptr, 0);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        fail("iot_uploader_progress", res);
+    }
+    PQclear(res);
+
+    if (!ok) {
+        return rollback();
+    }
+
+    // Deferred constraints are checked here
+    return exec("COMMIT") ? WRITE_OK : rollback();
+}
+
+bool PostgresSink::lastCommittedSeq(uint64_t& seq) {
+    if (!ensureConnected()) {
+        return false;
+    }
+
+    const char* params[1] = { _uploaderId.c_str() };
+    PGresult* res = PQexecParams(_conn,
+        "SELECT last_seq FROM iot_uploader_progress WHERE uploader_id = $1",
+        1, nullptr, params, nullptr, nullptr, 0);
+
+    bool ok = PQresultStatus(res) == PGRES_TUPLES_OK;
+    if (!ok) {
+        fail("lastCommittedSeq", res);
+    }
+
+    seq = 0;
+    if (ok && PQntuples(res) == 1) {
+        seq = strtoull(PQgetvalue(res, 0, 0), nullptr, 10);
+    }
+    PQclear(res);
+    return ok;
+}
+
+std::string PostgresSink::getLastError() {
+    return _lastError;
+}
@@ -0,0 +1,49 @@
+/*
+ * SmartFarm Edge Hub - PostgreSQL Upload Sink
+ * Version: 1.0.0
+ *
+ * Writes uploader batches to the Supabase/PostgreSQL schema with libpq:
+ * COPY into telemetry, one multi-row UPDATE of devices and the upload
+ * watermark (iot_uploader_progress), all in a single transaction.
+ * Failures are classified by SQLSTATE: constraint violations and data
+ * exceptions are permanent (WRITE_REJECTED), the rest are retried.
+ */
+
+#ifndef POSTGRES_SINK_H
+#define POSTGRES_SINK_H
+
+#include "TelemetryUploader.h"
+
+#include <libpq-fe.h>
+#include <string>
+
+class PostgresSink : public UploadSink {
+private:
+    std::string _conninfo;
+    std::string _uploaderId;  // Row key in iot_uploader_progress
+    PGconn* _conn;
+    std::string _lastError;
+    std::string _lastSqlState;  // SQLSTATE of the last failed statement, if any
+
+    bool ensureConnected();
+    bool exec(const char* sql);
+    void fail(const char* context, const PGresult* res = nullptr);
+    WriteStatus rollback();
+
+public:
+    PostgresSink(const std::string& conninfo, const std::string& uploaderId);
+    ~PostgresSink();
+
+    bool lookupFarms(const std::vector<std::string>& deviceIds,
+                     std::map<std::string, std::string>& farmIds) override;
+
+    WriteStatus writeBatch(const std::vector<WalEntry>& rows,
+                           const std::map<std::string, int64_t>& lastSeen,
+                           uint64_t lastSeq) override;
+
+    bool lastCommittedSeq(uint64_t& seq) override;
+
+    std::string getLastError();
+};
+
+#endif // POSTGRES_SINK_H
@@ -0,0 +1,291 @@
+/*
+ * SmartFarm Edge Hub - Batched Cloud Uploader Implementation
+ * Version: 1.0.0
+ */
+
+#include "TelemetryUploader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+TelemetryUploader::TelemetryUploader(TelemetryWal& wal, UploadSink& sink)
+    : _wal(wal), _sink(sink) {
+    _batchSize = DEFAULT_UPLOAD_BATCH_SIZE;
+    _uploadInterval = DEFAULT_UPLOAD_INTERVAL;
+    _retryDelay = DEFAULT_RETRY_DELAY;
+    _maxRetryDelay = DEFAULT_MAX_RETRY_DELAY;
+    _unknownDeviceTtl = DEFAULT_UNKNOWN_DEVICE_TTL;
+    _knownDeviceTtl = DEFAULT_KNOWN_DEVICE_TTL;
+    _running = false;
+    _recovered = false;
+    _stats = UploaderStats();
+}
+
+TelemetryUploader::~TelemetryUploader() {
+    stop();
+}
+
+void TelemetryUploader::setBatchSize(size_t batchSize) {
+    _batchSize = std::max<size_t>(1, batchSize);
+}
+
+void TelemetryUploader::setUploadInterval(unsigned long interval) {
+    _uploadInterval = interval;
+}
+
+void TelemetryUploader::setRetryDelay(unsigned long initial, unsigned long maximum) {
+    _retryDelay = initial;
+    _maxRetryDelay = std::max(initial, maximum);
+}
+
+void TelemetryUploader::setUnknownDeviceTtl(unsigned long ttl) {
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    _unknownDeviceTtl = ttl;
+}
+
+void TelemetryUploader::setKnownDeviceTtl(unsigned long ttl) {
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    _knownDeviceTtl = ttl;
+}
+
+bool TelemetryUploader::recover() {
+    std::lock_guard<std::mutex> lock(_flushMutex);
+    return recoverLocked();
+}
+
+// A crash between the database commit and the WAL commit leaves the batch
+// in both places; the watermark stored with the rows tells us to skip it
+bool TelemetryUploader::recoverLocked() {
+    uint64_t committed = 0;
+    if (!_sink.lastCommittedSeq(committed)) {
+        return false;
+    }
+
+    if (committed >= _wal.head()) {
+        _wal.commit(committed);
+    }
+    _recovered = true;
+    return true;
+}
+
+bool TelemetryUploader::submit(const TelemetryRecord& record) {
+    // Device clocks can't be trusted (firmware sends millis() / 1000), so
+    // rows are timed by the hub like /api/telemetry does
+    TelemetryRecord stamped = record;
+    if (stamped.receivedAt == 0) {
+        stamped.receivedAt = (int64_t)std::time(nullptr);
+    }
+
+    if (!_wal.append(stamped)) {
+        std::lock_guard<std::mutex> lock(_statsMutex);
+        _stats.rejectedBackpressure++;
+        return false;
+    }
+
+    if (_wal.pending() >= _batchSize) {
+        _wake.notify_one();
+    }
+    return true;
+}
+
+// Look up farms for devices not in the cache (or cached for longer than their
+// TTL), in one query per batch
+bool TelemetryUploader::resolveDevices(const std::vector<WalEntry>& entries) {
+    auto now = std::chrono::steady_clock::now();
+    auto unknownTtl = std::chrono::milliseconds(_unknownDeviceTtl);
+    auto knownTtl = std::chrono::milliseconds(_knownDeviceTtl);
+
+    std::vector<std::string> missing;
+    for (const WalEntry& entry : entries) {
+        std::string deviceId(entry.record.deviceId);
+        auto cached = _farmCache.find(deviceId);
+        bool stale = cached == _farmCache.end() ||
+                     now - cached->second.checkedAt >= (cached->second.farmId.empty() ? unknownTtl : knownTtl);
+        if (stale && std::find(missing.begin(), missing.end(), deviceId) == missing.end()) {
+            missing.push_back(deviceId);
+        }
+    }
+
+    if (missing.empty()) {
+        return true;
+    }
+
+    std::map<std::string, std::string> farmIds;
+    if (!_sink.lookupFarms(missing, farmIds)) {
+        return false;
+    }
+
+    for (const std::string& deviceId : missing) {
+        auto found = farmIds.find(deviceId);
+        _farmCache[deviceId] = { found != farmIds.end() ? found->second : "", now };
+    }
+    return true;
+}
+
+void TelemetryUploader::forgetDevices(const std::vector<WalEntry>& entries) {
+    for (const WalEntry& entry : entries) {
+        _farmCache.erase(std::string(entry.record.deviceId));
+    }
+}
+
+// Write entries [begin, end) and commit them from the WAL. Rows of unknown
+// devices are left out; an empty range only moves the watermark.
+WriteStatus TelemetryUploader::writeRange(const std::vector<WalEntry>& entries, size_t begin, size_t end) {
+    // Keep rows of known devices and coalesce last_seen to one value per device
+    std::vector<WalEntry> rows;
+    std::map<std::string, int64_t> lastSeen;
+    uint64_t rejected = 0;
+    rows.reserve(end - begin);
+
+    for (size_t i = begin; i < end; i++) {
+        const WalEntry& entry = entries[i];
+        std::string deviceId(entry.record.deviceId);
+        if (_farmCache[deviceId].farmId.empty()) {
+            rejected++;
+            continue;
+        }
+
+        rows.push_back(entry);
+        int64_t& seen = lastSeen[deviceId];
+        seen = std::max(seen, entry.record.receivedAt);
+    }
+
+    uint64_t lastSeq = entries[end > begin ? end - 1 : begin].seq;
+    WriteStatus status = _sink.writeBatch(rows, lastSeen, lastSeq);
+    if (status != WRITE_OK) {
+        return status;
+    }
+
+    _wal.commit(lastSeq);
+
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    _stats.rowsUploaded += rows.size();
+    _stats.batchesUploaded++;
+    _stats.deviceUpdates += lastSeen.size();
+    _stats.rejectedUnknownDevice += rejected;
+    return WRITE_OK;
+}
+
+// Split a rejected range until the bad rows are alone, then skip them. Each
+// piece commits in order, so the watermark still advances row by row.
+WriteStatus TelemetryUploader::isolateRejected(const std::vector<WalEntry>& entries, size_t begin, size_t end) {
+    if (end - begin == 1) {
+        WriteStatus status = writeRange(entries, begin, begin);
+        if (status == WRITE_OK) {
+            std::lock_guard<std::mutex> lock(_statsMutex);
+            _stats.rejectedPermanent++;
+        }
+        return status;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    size_t bounds[3] = { begin, middle, end };
+    for (int half = 0; half < 2; half++) {
+        WriteStatus status = writeRange(entries, bounds[half], bounds[half + 1]);
+        if (status == WRITE_REJECTED) {
+            status = isolateRejected(entries, bounds[half], bounds[half + 1]);
+        }
+        if (status != WRITE_OK) {
+            return status;
+        }
+    }
+    return WRITE_OK;
+}
+
+bool TelemetryUploader::flush() {
+    std::lock_guard<std::mutex> flushLock(_flushMutex);
+
+    if (!_recovered && !recoverLocked()) {
+        return false;
+    }
+
+    // Group commit: one msync per batch instead of per record
+    _wal.sync();
+
+    std::vector<WalEntry> entries;
+    if (_wal.read(_wal.head(), _batchSize, entries) == 0) {
+        return true;
+    }
+
+    if (!resolveDevices(entries)) {
+        return false;
+    }
+
+    WriteStatus status = writeRange(entries, 0, entries.size());
+    if (status == WRITE_REJECTED) {
+        // Most likely a cached device was deleted since: look the batch up again
+        forgetDevices(entries);
+        if (!resolveDevices(entries)) {
+            return false;
+        }
+        status = writeRange(entries, 0, entries.size());
+    }
+    if (status == WRITE_REJECTED) {
+        status = isolateRejected(entries, 0, entries.size());
+    }
+    return status == WRITE_OK;
+}
+
+void TelemetryUploader::workerLoop() {
+    unsigned long retryDelay = _retryDelay;
+
+    while (_running) {
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.wait_for(lock, std::chrono::milliseconds(_uploadInterval), [this]() {
+                return !_running || _wal.pending() >= _batchSize;
+            });
+        }
+
+        if (!_running) {
+            break;
+        }
+
+        // Drain full batches back-to-back, back off on failure
+        while (_running && _wal.pending() > 0) {
+            if (flush()) {
+                retryDelay = _retryDelay;
+                if (_wal.pending() < _batchSize) {
+                    break;
+                }
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_statsMutex);
+                _stats.retries++;
+            }
+
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.wait_for(lock, std::chrono::milliseconds(retryDelay), [this]() {
+                return !_running;
+            });
+            retryDelay = std::min(retryDelay * 2, _maxRetryDelay);
+        }
+    }
+}
+
+void TelemetryUploader::start() {
+    if (_running) {
+        return;
+    }
+    _running = true;
+    _worker = std::thread(&TelemetryUploader::workerLoop, this);
+}
+
+void TelemetryUploader::stop() {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+    _wake.notify_all();
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+}
+
+UploaderStats TelemetryUploader::getStats() {
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    return _stats;
+}
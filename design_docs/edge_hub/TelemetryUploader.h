@@ -0,0 +1,142 @@
+/*
+ * SmartFarm Edge Hub - Batched Cloud Uploader
+ * Version: 1.0.0
+ *
+ * Replaces the per-message select / update / insert round-trips of
+ * /api/telemetry with large batches:
+ * - validated telemetry is made durable in a TelemetryWal first
+ * - device -> farm lookups are cached in memory
+ * - devices.last_seen updates are coalesced to one row per device
+ * - rows, last_seen and the upload watermark commit in one transaction
+ * - batches the database rejects for good (e.g. a deleted device) are
+ *   re-resolved and narrowed down, so one bad row can't stall the WAL
+ */
+
+#ifndef TELEMETRY_UPLOADER_H
+#define TELEMETRY_UPLOADER_H
+
+#include "TelemetryWal.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define DEFAULT_UPLOAD_BATCH_SIZE 5000
+#define DEFAULT_UPLOAD_INTERVAL 1000   // ms between flushes when the batch isn't full
+#define DEFAULT_RETRY_DELAY 500        // ms, doubled after every failed attempt
+#define DEFAULT_MAX_RETRY_DELAY 30000  // ms
+#define DEFAULT_UNKNOWN_DEVICE_TTL 60000  // ms before an unknown device is looked up again
+#define DEFAULT_KNOWN_DEVICE_TTL 600000   // ms before a known device is looked up again
+
+// Outcome of UploadSink::writeBatch
+enum WriteStatus {
+    WRITE_OK,
+    WRITE_RETRY,    // Transient (connection, timeout): the same batch can succeed later
+    WRITE_REJECTED  // Permanent (constraint violation, bad data): it never will
+};
+
+// Destination for uploaded batches (PostgresSink, or a stand-in for testing)
+class UploadSink {
+public:
+    virtual ~UploadSink() {}
+
+    // Fill farmIds for the given devices; unknown devices are left out
+    virtual bool lookupFarms(const std::vector<std::string>& deviceIds,
+                             std::map<std::string, std::string>& farmIds) = 0;
+
+    // Atomically store rows, per-device last_seen and the WAL watermark
+    virtual WriteStatus writeBatch(const std::vector<WalEntry>& rows,
+                            const std::map<std::string, int64_t>& lastSeen,
+                            uint64_t lastSeq) = 0;
+
+    // Highest WAL sequence already committed (0 if none)
+    virtual bool lastCommittedSeq(uint64_t& seq) = 0;
+};
+
+struct UploaderStats {
+    uint64_t rowsUploaded;
+    uint64_t batchesUploaded;
+    uint64_t deviceUpdates;  // Coalesced last_seen rows
+    uint64_t retries;
+    uint64_t rejectedUnknownDevice;
+    uint64_t rejectedPermanent;  // Rows the database refused for good, skipped
+    uint64_t rejectedBackpressure;
+};
+
+class TelemetryUploader {
+private:
+    TelemetryWal& _wal;
+    UploadSink& _sink;
+
+    size_t _batchSize;
+    unsigned long _uploadInterval;
+    unsigned long _retryDelay;
+    unsigned long _maxRetryDelay;
+    unsigned long _unknownDeviceTtl;
+    unsigned long _knownDeviceTtl;
+
+    struct FarmCacheEntry {
+        std::string farmId;  // "" = device didn't exist when checked
+        std::chrono::steady_clock::time_point checkedAt;
+    };
+
+    // Device ID -> farm ID. Unknown devices are re-checked after _unknownDeviceTtl,
+    // so a device registered after its first message isn't dropped forever;
+    // known ones after _knownDeviceTtl, or at once when a batch is rejected.
+    std::unordered_map<std::string, FarmCacheEntry> _farmCache;
+
+    // Serializes flush() between the worker and other callers
+    std::mutex _flushMutex;
+
+    std::thread _worker;
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::atomic<bool> _running;
+    bool _recovered;
+
+    std::mutex _statsMutex;
+    UploaderStats _stats;
+
+    bool recoverLocked();
+    bool resolveDevices(const std::vector<WalEntry>& entries);
+    void forgetDevices(const std::vector<WalEntry>& entries);
+    WriteStatus writeRange(const std::vector<WalEntry>& entries, size_t begin, size_t end);
+    WriteStatus isolateRejected(const std::vector<WalEntry>& entries, size_t begin, size_t end);
+    void workerLoop();
+
+public:
+    TelemetryUploader(TelemetryWal& wal, UploadSink& sink);
+    ~TelemetryUploader();
+
+    void setBatchSize(size_t batchSize);
+    void setUploadInterval(unsigned long interval);
+    void setRetryDelay(unsigned long initial, unsigned long maximum);
+    void setUnknownDeviceTtl(unsigned long ttl);
+    void setKnownDeviceTtl(unsigned long ttl);
+
+    // Skip WAL records the sink already holds (done before the first flush)
+    bool recover();
+
+    // Queue one record; false when the WAL is full and the caller must back off
+    // A record with receivedAt = 0 is stamped with the current time.
+    bool submit(const TelemetryRecord& record);
+
+    // Upload one batch; false on a transient failure (records stay in the WAL).
+    // Rows the database rejects for good are skipped and counted instead.
+    // Safe to call while the worker runs (e.g. to drain on shutdown).
+    bool flush();
+
+    // Background upload thread with retry/backoff
+    void start();
+    void stop();
+
+    UploaderStats getStats();
+};
+
+#endif // TELEMETRY_UPLOADER_H
@@ -0,0 +1,262 @@
+/*
+ * SmartFarm Edge Hub - Bulk Telemetry Validation Implementation
+ * Version: 1.0.0
+ *
+ * Work is done 64 samples (one bitmap word) at a time: every field of the
+ * word is turned into NaN / sentinel / out-of-range bit masks, which are
+ * popcounted into the per-rule totals and cleared from the validity word.
+ * Presence bitmaps are applied to the masks, so absent samples cost the
+ * same as present ones and the kernels stay branch-free.
+ */
+
+#include "TelemetryValidator.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+  #define VALIDATOR_HAS_AVX2 1
+#endif
+
+#define MAX_VALIDATED_FIELDS 8
+
+struct FieldRule {
+    TelemetryColumn column;
+    float min;
+    float max;
+    ValidationRule rule;
+};
+
+struct WordMasks {
+    uint64_t nan;
+    uint64_t sentinel;
+    uint64_t range;  // Out of range, excluding NaN and sentinel
+};
+
+// Range rules from PROTOCOL.md (same as types/telemetry.ts)
+static size_t collectFields(const TelemetryBatch& batch, FieldRule* fields) {
+    const FieldRule all[MAX_VALIDATED_FIELDS] = {
+        { batch.temperature,    -40.0f,  80.0f,     RULE_TEMPERATURE_RANGE },
+        { batch.humidity,       0.0f,    100.0f,    RULE_HUMIDITY_RANGE },
+        { batch.soilMoisture,   0.0f,    100.0f,    RULE_SOIL_MOISTURE_RANGE },
+        { batch.lightLux,       0.0f,    100000.0f, RULE_LIGHT_RANGE },
+        { batch.ph,             0.0f,    14.0f,     RULE_PH_RANGE },
+        { batch.tds,            0.0f,    5000.0f,   RULE_TDS_RANGE },
+        { batch.batteryVoltage, 0.0f,    5.0f,      RULE_BATTERY_RANGE },
+        { batch.rssi,           -120.0f, 0.0f,      RULE_RSSI_RANGE },
+    };
+
+    size_t count = 0;
+    for (size_t i = 0; i < MAX_VALIDATED_FIELDS; i++) {
+        if (all[i].column.values) {
+            fields[count++] = all[i];
+        }
+    }
+    return count;
+}
+
+// ==================== PORTABLE KERNELS ====================
+
+// Comparisons produce 0/1 bytes with no data-dependent branches, so
+// compilers vectorize the loop (SSE2, NEON on ARM hubs); the bytes are
+// then packed into bits eight at a time (multiply trick, little-endian)
+static uint64_t packFlags(const uint8_t* flags, size_t n) {
+    uint64_t bits = 0;
+    for (size_t k = 0; k < n; k += 8) {
+        uint64_t eight;
+        memcpy(&eight, flags + k, 8);
+        bits |= ((eight * 0x0102040810204080ull) >> 56) << k;
+    }
+    return bits;
+}
+
+static WordMasks fieldMasksScalar(const float* values, size_t n, float min, float max) {
+    uint8_t nan[64] = {};
+    uint8_t sentinel[64] = {};
+    uint8_t range[64] = {};
+    for (size_t j = 0; j < n; j++) {
+        float x = values[j];
+        uint8_t isNan = x != x;
+        uint8_t isSentinel = x == SENSOR_ERROR_VALUE;
+        uint8_t inRange = (uint8_t)(x >= min) & (uint8_t)(x <= max);
+
+        nan[j] = isNan;
+        sentinel[j] = isSentinel;
+        range[j] = (inRange | isNan | isSentinel) ^ 1;
+    }
+
+    size_t packed = (n + 7) & ~(size_t)7;
+    WordMasks masks = { packFlags(nan, packed), packFlags(sentinel, packed), packFlags(range, packed) };
+    return masks;
+}
+
+static uint64_t duplicateMaskScalar(const TelemetryBatch& batch, size_t base, size_t n) {
+    uint64_t mask = 0;
+    for (size_t j = (base == 0 ? 1 : 0); j < n; j++) {
+        size_t i = base + j;
+        uint64_t sameTime = batch.timestamps[i] == batch.timestamps[i - 1];
+        uint64_t sameDevice = batch.deviceIndex ? batch.deviceIndex[i] == batch.deviceIndex[i - 1] : 1;
+        mask |= (sameTime & sameDevice) << j;
+    }
+    return mask;
+}
+
+// ==================== AVX2 KERNELS ====================
+
+#ifdef VALIDATOR_HAS_AVX2
+
+// 64 samples, 8 lanes at a time
+__attribute__((target("avx2")))
+static WordMasks fieldMasksAvx2(const float* values, float min, float max) {
+    const __m256 vmin = _mm256_set1_ps(min);
+    const __m256 vmax = _mm256_set1_ps(max);
+    const __m256 vsentinel = _mm256_set1_ps(SENSOR_ERROR_VALUE);
+
+    WordMasks masks = { 0, 0, 0 };
+    for (int k = 0; k < 8; k++) {
+        __m256 x = _mm256_loadu_ps(values + 8 * k);
+
+        uint64_t nanBits = (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(x, x, _CMP_UNORD_Q));
+        uint64_t sentinelBits = (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(x, vsentinel, _CMP_EQ_OQ));
+        __m256 inRange = _mm256_and_ps(_mm256_cmp_ps(x, vmin, _CMP_GE_OQ),
+                                       _mm256_cmp_ps(x, vmax, _CMP_LE_OQ));
+        uint64_t inBits = (uint64_t)_mm256_movemask_ps(inRange);
+
+        masks.nan |= nanBits << (8 * k);
+        masks.sentinel |= sentinelBits << (8 * k);
+        masks.range |= (~(inBits | nanBits | sentinelBits) & 0xFF) << (8 * k);
+    }
+    return masks;
+}
+
+// Compare each sample with its predecessor (base must be > 0)
+__attribute__((target("avx2")))
+static uint64_t duplicateMaskAvx2(const TelemetryBatch& batch, size_t base) {
+    uint64_t mask = 0;
+    for (int k = 0; k < 8; k++) {
+        size_t i = base + 8 * k;
+        const int64_t* ts = batch.timestamps;
+
+        __m256i lo = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(ts + i)),
+                                        _mm256_loadu_si256((const __m256i*)(ts + i - 1)));
+        __m256i hi = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*)(ts + i + 4)),
+                                        _mm256_loadu_si256((const __m256i*)(ts + i + 3)));
+        uint64_t sameTime = (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(lo)) |
+                            ((uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(hi)) << 4);
+
+        uint64_t sameDevice = 0xFF;
+        if (batch.deviceIndex) {
+            const uint32_t* dev = batch.deviceIndex;
+            __m256i eq = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i*)(dev + i)),
+                                            _mm256_loadu_si256((const __m256i*)(dev + i - 1)));
+            sameDevice = (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq));
+        }
+
+        mask |= (sameTime & sameDevice) << (8 * k);
+    }
+    return mask;
+}
+
+static bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif // VALIDATOR_HAS_AVX2
+
+// ==================== DRIVER ====================
+
+static void runValidation(const TelemetryBatch& batch, uint64_t* bitmap,
+                          ValidationResult& result, bool useAvx2) {
+    memset(&result, 0, sizeof(result));
+    if (batch.count == 0) {
+        return;
+    }
+
+    FieldRule fields[MAX_VALIDATED_FIELDS];
+    size_t fieldCount = collectFields(batch, fields);
+    size_t words = validationBitmapWords(batch.count);
+
+    for (size_t w = 0; w < words; w++) {
+        size_t base = w * 64;
+        size_t n = batch.count - base < 64 ? batch.count - base : 64;
+        bool fullWord = n == 64;
+
+        uint64_t valid = fullWord ? ~0ull : (1ull << n) - 1;
+        uint64_t nanAny = 0;
+        uint64_t sentinelAny = 0;
+
+        for (size_t f = 0; f < fieldCount; f++) {
+            const float* values = fields[f].column.values + base;
+            WordMasks masks;
+#ifdef VALIDATOR_HAS_AVX2
+            if (useAvx2 && fullWord) {
+                masks = fieldMasksAvx2(values, fields[f].min, fields[f].max);
+            } else
+#endif
+            {
+                masks = fieldMasksScalar(values, n, fields[f].min, fields[f].max);
+            }
+
+            // Samples without the field pass its rules
+            if (fields[f].column.present) {
+                uint64_t present = fields[f].column.present[w];
+                masks.nan &= present;
+                masks.sentinel &= present;
+                masks.range &= present;
+            }
+
+            nanAny |= masks.nan;
+            sentinelAny |= masks.sentinel;
+            result.rejects[fields[f].rule] += __builtin_popcountll(masks.range);
+            valid &= ~(masks.nan | masks.sentinel | masks.range);
+        }
+
+        uint64_t duplicates;
+#ifdef VALIDATOR_HAS_AVX2
+        if (useAvx2 && fullWord && base > 0) {
+            duplicates = duplicateMaskAvx2(batch, base);
+        } else
+#endif
+        {
+            duplicates = duplicateMaskScalar(batch, base, n);
+        }
+
+        result.rejects[RULE_NAN] += __builtin_popcountll(nanAny);
+        result.rejects[RULE_SENTINEL] += __builtin_popcountll(sentinelAny);
+        result.rejects[RULE_DUPLICATE_TIMESTAMP] += __builtin_popcountll(duplicates);
+        valid &= ~duplicates;
+
+        bitmap[w] = valid;
+        result.valid += __builtin_popcountll(valid);
+    }
+}
+
+void validateBatch(const TelemetryBatch& batch, uint64_t* bitmap, ValidationResult& result) {
+#ifdef VALIDATOR_HAS_AVX2
+    runValidation(batch, bitmap, result, cpuHasAvx2());
+#else
+    runValidation(batch, bitmap, result, false);
+#endif
+}
+
+void validateBatchScalar(const TelemetryBatch& batch, uint64_t* bitmap, ValidationResult& result) {
+    runValidation(batch, bitmap, result, false);
+}
+
+const char* validationRuleName(ValidationRule rule) {
+    switch (rule) {
+        case RULE_NAN: return "nan";
+        case RULE_SENTINEL: return "sensor_error";
+        case RULE_TEMPERATURE_RANGE: return "temperature_range";
+        case RULE_HUMIDITY_RANGE: return "humidity_range";
+        case RULE_SOIL_MOISTURE_RANGE: return "soil_moisture_range";
+        case RULE_LIGHT_RANGE: return "light_lux_range";
+        case RULE_PH_RANGE: return "ph_range";
+        case RULE_TDS_RANGE: return "tds_range";
+        case RULE_BATTERY_RANGE: return "battery_voltage_range";
+        case RULE_RSSI_RANGE: return "rssi_range";
+        case RULE_DUPLICATE_TIMESTAMP: return "duplicate_timestamp";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * SmartFarm Edge Hub - Bulk Telemetry Validation
+ * Version: 1.0.0
+ *
+ * Applies the PROTOCOL.md range rules to whole batches (replays after an
+ * outage, batched uploads) instead of one message at a time. Input is
+ * columnar (one array per field); output is a validity bitmap plus
+ * per-rule reject counts. Every pass is branch-free; AVX2 is used when
+ * the CPU supports it.
+ */
+
+#ifndef TELEMETRY_VALIDATOR_H
+#define TELEMETRY_VALIDATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Value used by TemperatureHumiditySensor when a DHT read fails
+#define SENSOR_ERROR_VALUE -999.0f
+
+enum ValidationRule {
+    RULE_NAN = 0,              // Any field is NaN
+    RULE_SENTINEL,             // Any field is SENSOR_ERROR_VALUE
+    RULE_TEMPERATURE_RANGE,    // -40 to 80 °C
+    RULE_HUMIDITY_RANGE,       // 0 to 100 %
+    RULE_SOIL_MOISTURE_RANGE,  // 0 to 100 %
+    RULE_LIGHT_RANGE,          // 0 to 100000 lux
+    RULE_PH_RANGE,             // 0 to 14
+    RULE_TDS_RANGE,            // 0 to 5000 ppm
+    RULE_BATTERY_RANGE,        // 0 to 5 V
+    RULE_RSSI_RANGE,           // -120 to 0 dBm
+    RULE_DUPLICATE_TIMESTAMP,  // Same device and timestamp as the previous sample
+    RULE_COUNT
+};
+
+// One field of a batch. A null column is a field the batch doesn't carry.
+// present is a bitmap of validationBitmapWords(count) words (bit i set =
+// sample i carries the field); null means every sample does. Values of
+// absent samples are ignored, whatever they hold.
+struct TelemetryColumn {
+    const float* values;
+    const uint64_t* present;
+};
+
+// Columnar batch. Samples must be grouped by device and ordered by time
+// for duplicate detection (the natural order of a replay).
+struct TelemetryBatch {
+    size_t count;
+    const int64_t* timestamps;      // Required
+    const uint32_t* deviceIndex;    // Optional, null = single device
+    TelemetryColumn temperature;
+    TelemetryColumn humidity;
+    TelemetryColumn soilMoisture;
+    TelemetryColumn lightLux;
+    TelemetryColumn ph;
+    TelemetryColumn tds;
+    TelemetryColumn batteryVoltage;
+    TelemetryColumn rssi;
+};
+
+struct ValidationResult {
+    size_t valid;                  // Samples passing every rule
+    uint64_t rejects[RULE_COUNT];  // Samples failing each rule (a sample may fail several)
+};
+
+// Bitmap words needed for count samples
+inline size_t validationBitmapWords(size_t count) {
+    return (count + 63) / 64;
+}
+
+// Validate with the fastest kernel for this CPU.
+// bitmap must hold validationBitmapWords(count) words; bit i set = sample i valid.
+void validateBatch(const TelemetryBatch& batch, uint64_t* bitmap, ValidationResult& result);
+
+// Portable kernel (also the fallback when AVX2 isn't available)
+void validateBatchScalar(const TelemetryBatch& batch, uint64_t* bitmap, ValidationResult& result);
+
+const char* validationRuleName(ValidationRule rule);
+
+#endif // TELEMETRY_VALIDATOR_H
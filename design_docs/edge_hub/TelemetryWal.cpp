@@ -0,0 +1,209 @@
+/*
+ * SmartFarm Edge Hub - Telemetry Write-Ahead Log Implementation
+ * Version: 1.0.0
+ */
+
+#include "TelemetryWal.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TelemetryWal::TelemetryWal() {
+    _fd = -1;
+    _map = nullptr;
+    _mapSize = 0;
+    _header = nullptr;
+    _slots = nullptr;
+}
+
+TelemetryWal::~TelemetryWal() {
+    close();
+}
+
+// FNV-1a over the record bytes (detects torn writes after a crash)
+uint32_t TelemetryWal::checksum(const TelemetryRecord& record) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&record);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(TelemetryRecord); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool TelemetryWal::open(const std::string& path, uint64_t capacity) {
+    close();
+
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (_fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(_fd, &st) != 0) {
+        close();
+        return false;
+    }
+
+    // An existing log keeps the capacity it was created with
+    bool fresh = st.st_size < (off_t)sizeof(Header);
+    if (!fresh) {
+        Header existing;
+        if (pread(_fd, &existing, sizeof(existing), 0) != (ssize_t)sizeof(existing) ||
+            existing.magic != WAL_MAGIC || existing.version != WAL_VERSION ||
+            existing.capacity == 0 || existing.capacity > (SIZE_MAX - sizeof(Header)) / sizeof(Slot)) {
+            close();
+            return false;
+        }
+
+        // Mapping past the end of a truncated file would SIGBUS on first access
+        if ((uint64_t)st.st_size < sizeof(Header) + existing.capacity * sizeof(Slot)) {
+            close();
+            return false;
+        }
+        capacity = existing.capacity;
+    }
+
+    _mapSize = sizeof(Header) + capacity * sizeof(Slot);
+    if (fresh && ftruncate(_fd, (off_t)_mapSize) != 0) {
+        close();
+        return false;
+    }
+
+    _map = mmap(nullptr, _mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (_map == MAP_FAILED) {
+        _map = nullptr;
+        close();
+        return false;
+    }
+
+    _header = static_cast<Header*>(_map);
+    _slots = reinterpret_cast<Slot*>(static_cast<uint8_t*>(_map) + sizeof(Header));
+
+    if (fresh) {
+        _header->magic = WAL_MAGIC;
+        _header->version = WAL_VERSION;
+        _header->capacity = capacity;
+        _header->head = 1;  // Sequence 0 marks an empty slot
+        _header->tail = 1;
+        sync();
+    } else {
+        recoverTail();
+    }
+
+    return true;
+}
+
+// Pick up records that were fully written but not yet counted in the header
+void TelemetryWal::recoverTail() {
+    while (_header->tail - _header->head < _header->capacity) {
+        const Slot& slot = _slots[_header->tail % _header->capacity];
+        if (slot.seq != _header->tail || slot.checksum != checksum(slot.record)) {
+            break;
+        }
+        _header->tail++;
+    }
+}
+
+void TelemetryWal::close() {
+    if (_map) {
+        msync(_map, _mapSize, MS_SYNC);
+        munmap(_map, _mapSize);
+        _map = nullptr;
+    }
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _header = nullptr;
+    _slots = nullptr;
+    _mapSize = 0;
+}
+
+bool TelemetryWal::append(const TelemetryRecord& record) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_header || _header->tail - _header->head >= _header->capacity) {
+        return false;
+    }
+
+    // Sequence is written last so a torn slot never looks valid
+    Slot& slot = _slots[_header->tail % _header->capacity];
+    slot.seq = 0;
+    memcpy(&slot.record, &record, sizeof(TelemetryRecord));
+    
+    // Readers treat the fixed-size strings as C strings
+    slot.record.deviceId[sizeof(slot.record.deviceId) - 1] = '\0';
+    slot.record.sensorType[sizeof(slot.record.sensorType) - 1] = '\0';
+    slot.record.protocolVersion[sizeof(slot.record.protocolVersion) - 1] = '\0';
+    
+    // Over the stored bytes (padding included), which recoverTail() rechecks
+    slot.checksum = checksum(slot.record);
+    __atomic_store_n(&slot.seq, _header->tail, __ATOMIC_RELEASE);
+    _header->tail++;
+    return true;
+}
+
+size_t TelemetryWal::read(uint64_t fromSeq, size_t maxCount, std::vector<WalEntry>& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    out.clear();
+    if (!_header) {
+        return 0;
+    }
+
+    // After a power loss the header can count slots whose pages never reached
+    // the disk. The log ends at the first one that doesn't check out.
+    uint64_t seq = fromSeq < _header->head ? _header->head : fromSeq;
+    while (seq < _header->tail && out.size() < maxCount) {
+        const Slot& slot = _slots[seq % _header->capacity];
+        if (slot.seq != seq || slot.checksum != checksum(slot.record)) {
+            _header->tail = seq;
+            msync(_map, sizeof(Header), MS_ASYNC);
+            break;
+        }
+        out.push_back({seq, slot.record});
+        seq++;
+    }
+    return out.size();
+}
+
+void TelemetryWal::commit(uint64_t seq) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (!_header || seq < _header->head) {
+        return;
+    }
+    _header->head = seq + 1 < _header->tail ? seq + 1 : _header->tail;
+    msync(_map, sizeof(Header), MS_ASYNC);
+}
+
+bool TelemetryWal::sync() {
+    if (!_map) {
+        return false;
+    }
+    return msync(_map, _mapSize, MS_SYNC) == 0;
+}
+
+uint64_t TelemetryWal::head() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _header ? _header->head : 0;
+}
+
+uint64_t TelemetryWal::tail() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _header ? _header->tail : 0;
+}
+
+uint64_t TelemetryWal::pending() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _header ? _header->tail - _header->head : 0;
+}
+
+uint64_t TelemetryWal::capacity() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _header ? _header->capacity : 0;
+}
@@ -0,0 +1,97 @@
+/*
+ * SmartFarm Edge Hub - Telemetry Write-Ahead Log
+ * Version: 1.0.0
+ *
+ * Fixed-size ring of telemetry records in an mmap'd file. Records are
+ * appended by the ingest path and removed only after the uploader has
+ * committed them to the database, so nothing is lost across a crash.
+ */
+
+#ifndef TELEMETRY_WAL_H
+#define TELEMETRY_WAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define WAL_MAGIC 0x4C415746  // "FWAL"
+#define WAL_VERSION 2
+#define DEFAULT_WAL_CAPACITY 262144  // records (~31 MB)
+
+// One validated sensor value, laid out for direct storage in the log
+struct TelemetryRecord {
+    char deviceId[40];
+    char sensorType[24];
+    double value;
+    int64_t timestamp;       // Unix epoch (seconds), as sent by the device
+    int64_t receivedAt;      // Unix epoch (seconds) when the hub received it
+    float batteryVoltage;    // 0 = not reported
+    int16_t rssi;            // 0 = not reported
+    char protocolVersion[6];
+};
+
+// Record read back from the log together with its sequence number
+struct WalEntry {
+    uint64_t seq;
+    TelemetryRecord record;
+};
+
+class TelemetryWal {
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        uint64_t head;  // First sequence not yet committed upstream
+        uint64_t tail;  // Next sequence to write
+    };
+
+    struct Slot {
+        uint64_t seq;
+        uint32_t checksum;
+        uint32_t reserved;
+        TelemetryRecord record;
+    };
+
+    int _fd;
+    void* _map;
+    size_t _mapSize;
+    Header* _header;
+    Slot* _slots;
+    std::mutex _mutex;
+
+    static uint32_t checksum(const TelemetryRecord& record);
+    void recoverTail();
+
+public:
+    TelemetryWal();
+    ~TelemetryWal();
+
+    // Open or create the log file; recovers records written before a crash.
+    // Fails on a file that isn't a log of this version or is shorter than its capacity.
+    bool open(const std::string& path, uint64_t capacity = DEFAULT_WAL_CAPACITY);
+    void close();
+
+    // Append one record; false when the log is full (caller must back off).
+    // String fields are truncated to their size - 1 if not NUL-terminated.
+    bool append(const TelemetryRecord& record);
+
+    // Copy up to maxCount uncommitted records starting at fromSeq. A slot that
+    // fails its sequence or checksum check ends the log there.
+    size_t read(uint64_t fromSeq, size_t maxCount, std::vector<WalEntry>& out);
+
+    // Drop every record up to and including seq
+    void commit(uint64_t seq);
+
+    // Flush written records to disk
+    bool sync();
+
+    uint64_t head();
+    uint64_t tail();
+    uint64_t pending();
+    uint64_t capacity();
+};
+
+#endif // TELEMETRY_WAL_H
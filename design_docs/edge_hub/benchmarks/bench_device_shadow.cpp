@@ -0,0 +1,131 @@
+/*
+ * DeviceShadow throughput: reads/s for 1..N reader threads while one
+ * writer updates devices as fast as it can, plus single-thread lookups
+ * at the maximum load factor (long probe chains, hits and misses).
+ *
+ * Usage: bench_device_shadow [devices] [milliseconds per run] [max readers]
+ */
+
+#include "DeviceShadow.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void fill(ShadowSensor* sensors, double value) {
+    for (int s = 0; s < SHADOW_MAX_SENSORS; s++) {
+        sensors[s].value = value;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t devices = argc > 1 ? strtoul(argv[1], nullptr, 10) : 14000;
+    const long runMs = argc > 2 ? strtol(argv[2], nullptr, 10) : 1000;
+    // One core is left to the writer; hardware_concurrency() may return 0
+    const unsigned maxReaders = argc > 3 ? strtoul(argv[3], nullptr, 10)
+                                         : std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    DeviceShadow shadow(DEFAULT_SHADOW_CAPACITY);
+    std::vector<std::string> ids;
+    for (size_t d = 0; d < devices; d++) {
+        ids.push_back("ESP32_" + std::to_string(100000 + d));
+    }
+
+    ShadowSensor sensors[SHADOW_MAX_SENSORS];
+    for (int s = 0; s < SHADOW_MAX_SENSORS; s++) {
+        snprintf(sensors[s].name, sizeof(sensors[s].name), "sensor_%d", s);
+    }
+    fill(sensors, 0);
+    for (size_t d = 0; d < devices; d++) {
+        if (!shadow.updateTelemetry(ids[d].c_str(), 0, sensors, SHADOW_MAX_SENSORS)) {
+            fprintf(stderr, "table full at %zu devices\n", d);
+            return 1;
+        }
+    }
+    printf("devices: %zu / %zu slots (load %.2f)\n", shadow.size(), shadow.capacity(),
+           (double)shadow.size() / shadow.capacity());
+
+    // Lookups on a full table, no writer
+    {
+        DeviceShadowState state;
+        size_t hits = 0;
+        const size_t lookups = devices * 20;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < lookups; i++) {
+            hits += shadow.read(ids[(i * 7919) % devices].c_str(), state);
+        }
+        double hitTime = seconds(start);
+
+        std::vector<std::string> absent;
+        for (size_t d = 0; d < 4096; d++) {
+            absent.push_back("ESP8266_" + std::to_string(d));
+        }
+        start = Clock::now();
+        for (size_t i = 0; i < lookups; i++) {
+            hits += shadow.read(absent[i % absent.size()].c_str(), state);
+        }
+        double missTime = seconds(start);
+        printf("lookup hit:  %.1f M/s\n", lookups / hitTime / 1e6);
+        printf("lookup miss: %.1f M/s\n", lookups / missTime / 1e6);
+        if (hits != lookups) {
+            return 1;
+        }
+    }
+
+    // Readers under a writer that never pauses
+    long tornTotal = 0;
+    for (unsigned readers = 1; readers <= (maxReaders ? maxReaders : 1); readers *= 2) {
+        std::atomic<bool> done(false);
+        std::atomic<uint64_t> reads(0);
+        std::atomic<long> torn(0);
+
+        std::vector<std::thread> threads;
+        for (unsigned r = 0; r < readers; r++) {
+            threads.emplace_back([&, r]() {
+                DeviceShadowState state;
+                uint64_t count = 0;
+                size_t d = r * 1009;
+                while (!done.load(std::memory_order_relaxed)) {
+                    d = (d + 7919) % devices;
+                    shadow.read(ids[d].c_str(), state);
+                    if (state.sensors[SHADOW_MAX_SENSORS - 1].value != (double)state.telemetryTime) {
+                        torn++;
+                    }
+                    count++;
+                }
+                reads += count;
+            });
+        }
+
+        uint64_t writes = 0;
+        Clock::time_point start = Clock::now();
+        while (seconds(start) * 1000 < runMs) {
+            for (int batch = 0; batch < 1024; batch++, writes++) {
+                fill(sensors, (double)writes);
+                shadow.updateTelemetry(ids[writes % devices].c_str(), (int64_t)writes, sensors, SHADOW_MAX_SENSORS);
+            }
+        }
+        double elapsed = seconds(start);
+        done = true;
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        printf("readers %2u: %7.2f M reads/s (%.2f M/s per thread), writer %.2f M updates/s, torn %ld\n",
+               readers, reads / elapsed / 1e6, reads / elapsed / 1e6 / readers, writes / elapsed / 1e6,
+               torn.load());
+        tornTotal += torn;
+    }
+    return tornTotal == 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * Fan-out latency on a simulated fleet: time from one farm-wide command
+ * to the last device acknowledgement, and the peak response rate the
+ * broker sees, for several jitter settings. Time is simulated, so the
+ * figures show the protocol behaviour, not host speed.
+ *
+ * Usage: bench_fanout [devices]
+ */
+
+#include "SimulatedFleet.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+
+int main(int argc, char** argv) {
+    const size_t devices = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000;
+    const unsigned long jitters[] = { 0, 500, 2000, 5000 };
+    bool complete = true;
+
+    printf("%zu devices, 10 ms loop()\n", devices);
+    printf("%8s %14s %14s %18s\n", "jitter", "last ack (ms)", "p50 ack (ms)", "peak acks/100 ms");
+
+    for (unsigned long jitter : jitters) {
+        SimulatedFleet fleet(devices, jitter);
+
+        std::string requestId = "req-" + std::to_string(jitter);
+        unsigned long sent = millis();
+        fleet.publishFarm("{\"command\":\"ping\",\"request_id\":\"" + requestId + "\"}");
+        fleet.run(jitter + 1000);
+
+        std::vector<FanoutResponse> responses = fleet.responses(requestId);
+        std::vector<unsigned long> latencies;
+        std::map<unsigned long, int> perBucket;
+        for (const FanoutResponse& response : responses) {
+            latencies.push_back(response.time - sent);
+            perBucket[(response.time - sent) / 100]++;
+        }
+        std::sort(latencies.begin(), latencies.end());
+
+        int peak = 0;
+        for (const auto& bucket : perBucket) {
+            peak = max(peak, bucket.second);
+        }
+        complete = complete && responses.size() == devices;
+
+        printf("%8lu %14lu %14lu %18d%s\n", jitter,
+               latencies.empty() ? 0 : latencies.back(),
+               latencies.empty() ? 0 : latencies[latencies.size() / 2],
+               peak, responses.size() == devices ? "" : "  (missing acks)");
+    }
+    return complete ? 0 : 1;
+}
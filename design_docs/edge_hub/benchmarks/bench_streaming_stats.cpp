@@ -0,0 +1,41 @@
+/*
+ * StreamingStats::add() throughput on the host, for a sense of how much
+ * of a loop() iteration sampling costs. Divide by the MCU/host speed
+ * ratio (roughly 20-50x for an ESP32) for on-device figures.
+ *
+ * Usage: bench_streaming_stats [samples]
+ */
+
+#include "SmartFarmStats.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+int main(int argc, char** argv) {
+    const size_t samples = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+
+    // Pump power: idle, then running with spikes
+    std::mt19937 rng(3);
+    std::normal_distribution<float> noise(40.0f, 5.0f);
+    std::vector<float> values(4096);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = i % 512 < 128 ? 0.0f : noise(rng) + (i % 97 == 0 ? 60.0f : 0.0f);
+    }
+
+    StreamingStats stats;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < samples; i++) {
+        stats.add(values[i % values.size()], 0.01f);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    printf("%zu samples: %.1f M samples/s (%.1f ns/sample)\n", samples, samples / elapsed / 1e6,
+           elapsed * 1e9 / samples);
+    printf("mean %.2f, p95 %.2f, energy %.1f J\n", stats.getMean(), stats.getP95(), stats.getIntegral());
+    return stats.getCount() == samples ? 0 : 1;
+}
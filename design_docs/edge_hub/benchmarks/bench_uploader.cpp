@@ -0,0 +1,68 @@
+/*
+ * Uploader throughput: rows/s through WAL + batching + coalescing into an
+ * in-memory sink, i.e. everything except the database round-trip.
+ *
+ * Usage: bench_uploader [rows]
+ */
+
+#include "TelemetryUploader.h"
+#include "StandInSink.h"
+#include "TestSupport.h"
+
+#include <chrono>
+#include <cstdlib>
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t rows = argc > 1 ? strtoul(argv[1], nullptr, 10) : 2000000;
+    const int devices = 1000;
+
+    TempDir dir;
+    TelemetryWal wal;
+    if (!wal.open(dir.file("telemetry.wal"), 1 << 21)) {
+        fprintf(stderr, "cannot open WAL in %s\n", dir.path.c_str());
+        return 1;
+    }
+
+    StandInSink sink;
+    std::vector<std::string> names;
+    for (int i = 0; i < devices; i++) {
+        names.push_back("ESP32_" + std::to_string(i));
+        sink.devices.insert(names.back());
+    }
+    sink.rows.reserve(rows);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(DEFAULT_UPLOAD_BATCH_SIZE);
+    uploader.setUploadInterval(10);
+    uploader.start();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < rows; i++) {
+        TelemetryRecord record = makeRecord(names[i % devices].c_str(), (double)i, (int64_t)(i / devices));
+        while (!uploader.submit(record)) {
+            std::this_thread::yield();
+        }
+    }
+    double submitted = seconds(start);
+
+    while (wal.pending() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double uploaded = seconds(start);
+    uploader.stop();
+
+    UploaderStats stats = uploader.getStats();
+    printf("rows:           %zu (%d devices, batch %d)\n", rows, devices, DEFAULT_UPLOAD_BATCH_SIZE);
+    printf("submit:         %.0f rows/s\n", rows / submitted);
+    printf("end to end:     %.0f rows/s\n", rows / uploaded);
+    printf("batches:        %llu\n", (unsigned long long)stats.batchesUploaded);
+    printf("last_seen rows: %llu (%.1f per batch instead of %d)\n",
+           (unsigned long long)stats.deviceUpdates,
+           (double)stats.deviceUpdates / (stats.batchesUploaded ? stats.batchesUploaded : 1),
+           DEFAULT_UPLOAD_BATCH_SIZE);
+    return stats.rowsUploaded == rows ? 0 : 1;
+}
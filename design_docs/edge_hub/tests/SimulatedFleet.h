@@ -0,0 +1,96 @@
+/*
+ * Fleet of SmartFarmIoT devices on one simulated broker, for fan-out
+ * tests and benchmarks. Time advances in fixed ticks; every tick runs
+ * loop() once on every device.
+ */
+
+#ifndef SIMULATED_FLEET_H
+#define SIMULATED_FLEET_H
+
+#include "SmartFarmIoT.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FLEET_BROKER "edge.local"
+#define FLEET_FARM_ID "farm-1"
+
+struct FanoutResponse {
+    std::string deviceId;
+    std::string requestId;
+    std::string scope;
+    unsigned long time;     // millis() at the broker
+    unsigned long latency;  // Reported by the device
+};
+
+class SimulatedFleet {
+public:
+    std::vector<std::unique_ptr<SmartFarmIoT>> devices;
+    unsigned long tick = 10;  // ms
+
+    SimulatedFleet(size_t count, unsigned long jitter) {
+        fake::network().reset();
+        fake::network().broker(FLEET_BROKER, 1883);
+
+        for (size_t i = 0; i < count; i++) {
+            devices.emplace_back(new SmartFarmIoT(deviceId(i).c_str(), "token"));
+            SmartFarmIoT& device = *devices.back();
+            device.addBroker(FLEET_BROKER);
+            device.setResponseJitter(jitter);
+            device.begin("farm-wifi", "secret");
+            device.setFarmId(FLEET_FARM_ID);
+        }
+    }
+
+    static std::string deviceId(size_t i) {
+        return "ESP32_FLEET_" + std::to_string(i);
+    }
+
+    fake::Broker& broker() {
+        return fake::network().broker(FLEET_BROKER, 1883);
+    }
+
+    void publish(const std::string& topic, const std::string& payload) {
+        broker().publish({ topic, payload, false, millis(), "platform" });
+    }
+
+    void publishFarm(const std::string& payload) {
+        publish(std::string("fleet/") + FLEET_FARM_ID + "/command", payload);
+    }
+
+    void publishGroup(const std::string& group, const std::string& payload) {
+        publish(std::string("fleet/") + FLEET_FARM_ID + "/group/" + group + "/command", payload);
+    }
+
+    void run(unsigned long ms) {
+        unsigned long end = millis() + ms;
+        while (millis() < end) {
+            for (auto& device : devices) {
+                device->loop();
+            }
+            fake::advance(tick);
+        }
+    }
+
+    std::vector<FanoutResponse> responses(const std::string& requestId) {
+        std::vector<FanoutResponse> found;
+        for (const fake::Message& message : broker().published) {
+            if (message.topic.size() < 9 || message.topic.compare(message.topic.size() - 9, 9, "/response") != 0) {
+                continue;
+            }
+            StaticJsonDocument<512> doc;
+            if (deserializeJson(doc, message.payload.c_str())) {
+                continue;
+            }
+            if (requestId != (doc["request_id"] | "")) {
+                continue;
+            }
+            found.push_back({ doc["device_id"] | "", requestId, doc["scope"] | "", message.time,
+                              doc["latency"] | 0UL });
+        }
+        return found;
+    }
+};
+
+#endif // SIMULATED_FLEET_H
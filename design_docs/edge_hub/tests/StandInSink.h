@@ -0,0 +1,168 @@
+/*
+ * SmartFarm Edge Hub - In-Memory Upload Sink for Tests and Benchmarks
+ *
+ * Behaves like PostgresSink: a batch, its last_seen values and the
+ * watermark commit together or not at all. Rows of unregistered devices
+ * (the foreign key) and badSeqs are rejected for good. With a path, every commit is
+ * persisted (write to a temp file + rename), so a process that dies and
+ * a new one that reopens the same path see the same "database".
+ */
+
+#ifndef STAND_IN_SINK_H
+#define STAND_IN_SINK_H
+
+#include "TelemetryUploader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <unistd.h>
+
+#define CRASH_EXIT_STATUS 86  // Exit status of a process killed by a CrashPoint
+
+class StandInSink : public UploadSink {
+public:
+    enum CrashPoint {
+        NO_CRASH,
+        CRASH_BEFORE_COMMIT,  // Process dies inside the transaction (rolled back)
+        CRASH_AFTER_COMMIT    // Process dies after the commit, before the WAL commit
+    };
+
+    struct Row {
+        uint64_t seq;
+        std::string deviceId;
+        double value;
+    };
+
+    std::vector<Row> rows;
+    std::map<std::string, int64_t> lastSeen;
+    uint64_t watermark = 0;
+    std::set<std::string> devices;  // Registered device IDs (farm = "farm-1")
+    std::set<uint64_t> badSeqs;     // Rows that violate some other constraint
+
+    size_t batches = 0;
+    size_t lookups = 0;
+    size_t rejectedBatches = 0;
+    bool failWrites = false;  // Transient failure (database unreachable)
+
+    CrashPoint crashPoint = NO_CRASH;
+    size_t crashOnBatch = 0;  // 1-based batch number
+
+    explicit StandInSink(const std::string& path = "") : _path(path) {
+        load();
+    }
+
+    bool lookupFarms(const std::vector<std::string>& deviceIds,
+                     std::map<std::string, std::string>& farmIds) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        lookups++;
+        for (const std::string& deviceId : deviceIds) {
+            if (devices.count(deviceId)) {
+                farmIds[deviceId] = "farm-1";
+            }
+        }
+        return true;
+    }
+
+    WriteStatus writeBatch(const std::vector<WalEntry>& batch,
+                           const std::map<std::string, int64_t>& seen,
+                           uint64_t lastSeq) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (failWrites) {
+            return WRITE_RETRY;
+        }
+        for (const WalEntry& entry : batch) {
+            if (!devices.count(entry.record.deviceId) || badSeqs.count(entry.seq)) {
+                rejectedBatches++;
+                return WRITE_REJECTED;
+            }
+        }
+
+        batches++;
+        if (crashPoint == CRASH_BEFORE_COMMIT && batches == crashOnBatch) {
+            _exit(CRASH_EXIT_STATUS);
+        }
+
+        for (const WalEntry& entry : batch) {
+            rows.push_back({ entry.seq, entry.record.deviceId, entry.record.value });
+        }
+        for (const auto& device : seen) {
+            int64_t& current = lastSeen[device.first];
+            current = std::max(current, device.second);
+        }
+        watermark = lastSeq;
+        save();
+
+        if (crashPoint == CRASH_AFTER_COMMIT && batches == crashOnBatch) {
+            _exit(CRASH_EXIT_STATUS);
+        }
+        return WRITE_OK;
+    }
+
+    bool lastCommittedSeq(uint64_t& seq) override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        seq = watermark;
+        return true;
+    }
+
+private:
+    std::string _path;
+    std::mutex _mutex;
+
+    void load() {
+        if (_path.empty()) {
+            return;
+        }
+        FILE* file = fopen(_path.c_str(), "r");
+        if (!file) {
+            return;
+        }
+        unsigned long long seq;
+        char deviceId[64];
+        double value;
+        if (fscanf(file, "%llu", &seq) == 1) {
+            watermark = seq;
+        }
+        while (fscanf(file, "%llu %63s %lf", &seq, deviceId, &value) == 3) {
+            rows.push_back({ seq, deviceId, value });
+        }
+        fclose(file);
+    }
+
+    void save() {
+        if (_path.empty()) {
+            return;
+        }
+        std::string temp = _path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "w");
+        if (!file) {
+            abort();
+        }
+        fprintf(file, "%llu\n", (unsigned long long)watermark);
+        for (const Row& row : rows) {
+            fprintf(file, "%llu %s %.17g\n", (unsigned long long)row.seq, row.deviceId.c_str(), row.value);
+        }
+        fclose(file);
+        if (rename(temp.c_str(), _path.c_str()) != 0) {
+            abort();
+        }
+    }
+};
+
+// Record for a registered device
+inline TelemetryRecord makeRecord(const char* deviceId, double value, int64_t timestamp) {
+    TelemetryRecord record = {};
+    snprintf(record.deviceId, sizeof(record.deviceId), "%s", deviceId);
+    snprintf(record.sensorType, sizeof(record.sensorType), "temperature");
+    snprintf(record.protocolVersion, sizeof(record.protocolVersion), "1.0");
+    record.value = value;
+    record.timestamp = timestamp;
+    record.receivedAt = 0;  // Stamped by TelemetryUploader::submit()
+    record.batteryVoltage = 3.7f;
+    record.rssi = -65;
+    return record;
+}
+
+#endif // STAND_IN_SINK_H
@@ -0,0 +1,104 @@
+/*
+ * SmartFarm Edge Hub - Minimal Test Support
+ *
+ * Each test binary defines cases with TEST(name) and ends with TEST_MAIN().
+ * A failed CHECK reports file:line and fails the binary (ctest), but the
+ * remaining checks and cases still run.
+ */
+
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& testRegistry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar {
+    TestRegistrar(const char* name, void (*run)()) {
+        testRegistry().push_back({ name, run });
+    }
+};
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistrar name##_registrar(#name, name); \
+    static void name()
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            testFailures()++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        if (!((a) == (b))) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, \
+                    #a, #b, (long long)(a), (long long)(b)); \
+            testFailures()++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+    do { \
+        double checkA = (a), checkB = (b); \
+        if (!(std::fabs(checkA - checkB) <= (tolerance))) { \
+            fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g (tolerance %g)\n", __FILE__, \
+                    __LINE__, #a, #b, checkA, checkB, (double)(tolerance)); \
+            testFailures()++; \
+        } \
+    } while (0)
+
+// Scratch directory removed at scope exit
+struct TempDir {
+    std::string path;
+
+    TempDir() {
+        char pattern[] = "/tmp/smartfarm-test-XXXXXX";
+        path = mkdtemp(pattern) ? pattern : "";
+    }
+    ~TempDir() {
+        if (!path.empty()) {
+            std::string command = "rm -rf '" + path + "'";
+            if (system(command.c_str()) != 0) {
+                fprintf(stderr, "could not remove %s\n", path.c_str());
+            }
+        }
+    }
+    std::string file(const char* name) const { return path + "/" + name; }
+};
+
+inline int runTests() {
+    for (const TestCase& test : testRegistry()) {
+        int before = testFailures();
+        test.run();
+        printf("%s %s\n", testFailures() == before ? "[ OK ]" : "[FAIL]", test.name);
+    }
+    return testFailures() == 0 ? 0 : 1;
+}
+
+#define TEST_MAIN() \
+    int main() { \
+        return runTests(); \
+    }
+
+#endif // TEST_SUPPORT_H
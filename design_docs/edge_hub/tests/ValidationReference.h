@@ -0,0 +1,150 @@
+/*
+ * Per-sample, branchy version of the TelemetryValidator rules: one
+ * sample and one field at a time, the way a per-message check is
+ * written. Reference for the tests and baseline for the benchmark.
+ * SyntheticReplay builds mixed replays to feed both.
+ */
+
+#ifndef VALIDATION_REFERENCE_H
+#define VALIDATION_REFERENCE_H
+
+#include "TelemetryValidator.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+struct ReferenceField {
+    TelemetryColumn column;
+    float min;
+    float max;
+    ValidationRule rule;
+};
+
+inline bool referenceHas(const TelemetryColumn& column, size_t i) {
+    return column.values && (!column.present || (column.present[i / 64] >> (i % 64)) & 1);
+}
+
+inline void validateBatchReference(const TelemetryBatch& batch, uint64_t* bitmap, ValidationResult& result) {
+    const ReferenceField fields[] = {
+        { batch.temperature,    -40.0f,  80.0f,     RULE_TEMPERATURE_RANGE },
+        { batch.humidity,       0.0f,    100.0f,    RULE_HUMIDITY_RANGE },
+        { batch.soilMoisture,   0.0f,    100.0f,    RULE_SOIL_MOISTURE_RANGE },
+        { batch.lightLux,       0.0f,    100000.0f, RULE_LIGHT_RANGE },
+        { batch.ph,             0.0f,    14.0f,     RULE_PH_RANGE },
+        { batch.tds,            0.0f,    5000.0f,   RULE_TDS_RANGE },
+        { batch.batteryVoltage, 0.0f,    5.0f,      RULE_BATTERY_RANGE },
+        { batch.rssi,           -120.0f, 0.0f,      RULE_RSSI_RANGE },
+    };
+
+    memset(&result, 0, sizeof(result));
+    memset(bitmap, 0, validationBitmapWords(batch.count) * sizeof(uint64_t));
+
+    for (size_t i = 0; i < batch.count; i++) {
+        bool valid = true;
+        bool nan = false;
+        bool sentinel = false;
+
+        for (const ReferenceField& field : fields) {
+            if (!referenceHas(field.column, i)) {
+                continue;
+            }
+            float x = field.column.values[i];
+            if (x != x) {
+                nan = true;
+            } else if (x == SENSOR_ERROR_VALUE) {
+                sentinel = true;
+            } else if (x < field.min || x > field.max) {
+                result.rejects[field.rule]++;
+                valid = false;
+            }
+        }
+        if (nan) {
+            result.rejects[RULE_NAN]++;
+            valid = false;
+        }
+        if (sentinel) {
+            result.rejects[RULE_SENTINEL]++;
+            valid = false;
+        }
+
+        if (i > 0 && batch.timestamps[i] == batch.timestamps[i - 1] &&
+            (!batch.deviceIndex || batch.deviceIndex[i] == batch.deviceIndex[i - 1])) {
+            result.rejects[RULE_DUPLICATE_TIMESTAMP]++;
+            valid = false;
+        }
+
+        if (valid) {
+            bitmap[i / 64] |= 1ull << (i % 64);
+            result.valid++;
+        }
+    }
+}
+
+// Replay of several devices with in-range values, a given share of bad
+// values (out of range, NaN, -999), duplicate timestamps, and optional
+// fields that some samples lack
+struct SyntheticReplay {
+    std::vector<int64_t> timestamps;
+    std::vector<uint32_t> devices;
+    std::vector<float> columns[8];
+    std::vector<uint64_t> present[8];
+    TelemetryBatch batch;
+
+    SyntheticReplay(size_t count, double badShare, double absentShare, uint32_t seed = 1) {
+        static const float ranges[8][2] = {
+            { -40, 80 }, { 0, 100 }, { 0, 100 }, { 0, 100000 }, { 0, 14 }, { 0, 5000 }, { 0, 5 }, { -120, 0 },
+        };
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<double> unit(0, 1);
+
+        uint32_t device = 0;
+        int64_t time = 1700000000;
+        for (size_t i = 0; i < count; i++) {
+            if (unit(rng) < 0.01) {
+                device++;  // Next device's run
+            }
+            if (unit(rng) >= badShare / 4) {
+                time += 60;  // Otherwise a duplicate
+            }
+            timestamps.push_back(time);
+            devices.push_back(device);
+        }
+
+        for (int f = 0; f < 8; f++) {
+            present[f].assign(validationBitmapWords(count), 0);
+            for (size_t i = 0; i < count; i++) {
+                float lo = ranges[f][0];
+                float hi = ranges[f][1];
+                float x = lo + (hi - lo) * (float)unit(rng);
+                double bad = unit(rng);
+                if (bad < badShare / 3) {
+                    x = hi + 1 + (hi - lo) * (float)unit(rng);
+                } else if (bad < badShare / 2) {
+                    x = NAN;
+                } else if (bad < badShare * 2 / 3) {
+                    x = SENSOR_ERROR_VALUE;
+                }
+                if (unit(rng) >= absentShare) {
+                    present[f][i / 64] |= 1ull << (i % 64);
+                } else if (unit(rng) < 0.5) {
+                    x = NAN;  // Absent samples hold anything
+                }
+                columns[f].push_back(x);
+            }
+        }
+
+        batch = {};
+        batch.count = count;
+        batch.timestamps = timestamps.data();
+        batch.deviceIndex = devices.data();
+        TelemetryColumn* fields[8] = { &batch.temperature, &batch.humidity, &batch.soilMoisture, &batch.lightLux,
+                                       &batch.ph, &batch.tds, &batch.batteryVoltage, &batch.rssi };
+        for (int f = 0; f < 8; f++) {
+            *fields[f] = { columns[f].data(), absentShare > 0 ? present[f].data() : nullptr };
+        }
+    }
+};
+
+#endif // VALIDATION_REFERENCE_H
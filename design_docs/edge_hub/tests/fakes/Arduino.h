@@ -0,0 +1,160 @@
+/*
+ * Host fake of the Arduino core used by the Arduino library tests.
+ *
+ * Time is simulated: millis()/micros() only move when a test (or the code
+ * under test) calls delay() or fake::advance(), so timing-dependent logic
+ * is deterministic.
+ */
+
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+typedef uint8_t byte;
+
+#define ESP_ARDUINO_VERSION_MAJOR 3  // WiFiClient::setTimeout() takes ms
+
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+namespace fake {
+
+inline uint64_t& clockMicros() {
+    static uint64_t now = 0;
+    return now;
+}
+
+inline void advance(unsigned long ms) {
+    clockMicros() += (uint64_t)ms * 1000;
+}
+
+inline void advanceMicros(unsigned long us) {
+    clockMicros() += us;
+}
+
+inline std::mt19937& rng() {
+    static std::mt19937 engine(12345);
+    return engine;
+}
+
+} // namespace fake
+
+inline unsigned long millis() {
+    return (unsigned long)(fake::clockMicros() / 1000);
+}
+
+inline unsigned long micros() {
+    return (unsigned long)fake::clockMicros();
+}
+
+inline void delay(unsigned long ms) {
+    fake::advance(ms);
+}
+
+inline long random(long howbig) {
+    return howbig <= 0 ? 0 : (long)(fake::rng()() % (unsigned long)howbig);
+}
+
+inline long random(long howsmall, long howbig) {
+    return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall);
+}
+
+inline void randomSeed(unsigned long seed) {
+    fake::rng().seed(seed);
+}
+
+// Subset of Arduino's String used by the library
+class String {
+private:
+    std::string _value;
+
+public:
+    String() {}
+    String(const char* value) : _value(value ? value : "") {}
+    String(const std::string& value) : _value(value) {}
+    explicit String(char c) : _value(1, c) {}
+    explicit String(int value) : _value(std::to_string(value)) {}
+    explicit String(unsigned int value) : _value(std::to_string(value)) {}
+    explicit String(long value) : _value(std::to_string(value)) {}
+    explicit String(unsigned long value) : _value(std::to_string(value)) {}
+    explicit String(float value, int decimals = 2) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        _value = buf;
+    }
+
+    const char* c_str() const { return _value.c_str(); }
+    unsigned int length() const { return (unsigned int)_value.size(); }
+
+    int indexOf(char c) const {
+        size_t pos = _value.find(c);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const char* s) const {
+        size_t pos = _value.find(s);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    bool startsWith(const String& prefix) const {
+        return _value.compare(0, prefix._value.size(), prefix._value) == 0;
+    }
+    String substring(unsigned int from) const { return String(_value.substr(from)); }
+    String substring(unsigned int from, unsigned int to) const { return String(_value.substr(from, to - from)); }
+    long toInt() const { return atol(_value.c_str()); }
+
+    String& operator+=(const String& other) { _value += other._value; return *this; }
+    String& operator+=(const char* other) { _value += other; return *this; }
+    String& operator+=(char c) { _value += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a._value + b._value); }
+    friend String operator+(const String& a, const char* b) { return String(a._value + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b._value); }
+
+    friend bool operator==(const String& a, const String& b) { return a._value == b._value; }
+    friend bool operator==(const String& a, const char* b) { return a._value == (b ? b : ""); }
+    friend bool operator!=(const String& a, const String& b) { return !(a == b); }
+    friend bool operator!=(const String& a, const char* b) { return !(a == b); }
+};
+
+// Serial output is discarded (set SMARTFARM_TEST_VERBOSE=1 to see it)
+class FakeSerial {
+private:
+    static bool verbose() {
+        static const bool enabled = getenv("SMARTFARM_TEST_VERBOSE") != nullptr;
+        return enabled;
+    }
+
+public:
+    void begin(unsigned long) {}
+    void print(const String& s) { if (verbose()) fputs(s.c_str(), stdout); }
+    void print(const char* s) { if (verbose()) fputs(s, stdout); }
+    void print(int v) { if (verbose()) printf("%d", v); }
+    void println() { if (verbose()) fputs("\n", stdout); }
+    void println(const String& s) { if (verbose()) puts(s.c_str()); }
+    void println(const char* s) { if (verbose()) puts(s); }
+    void println(int v) { if (verbose()) printf("%d\n", v); }
+    template <typename... Args>
+    void printf(const char* format, Args... args) { if (verbose()) ::printf(format, args...); }
+};
+
+inline FakeSerial Serial;
+
+class FakeEsp {
+public:
+    unsigned long restarts = 0;
+    uint32_t getFreeHeap() { return 180000; }
+    void restart() { restarts++; }
+};
+
+inline FakeEsp ESP;
+
+#endif // FAKE_ARDUINO_H
@@ -0,0 +1,720 @@
+/*
+ * Host fake of the ArduinoJson 6 API subset used by the library.
+ *
+ * Real JSON in and out, plus the memory accounting that matters for
+ * sizing: on a 32-bit MCU every object member costs one 16-byte slot and
+ * copied strings (String values/keys, deserialized text) cost length + 1.
+ * const char* keys and values are linked, not copied. When a document
+ * runs out of capacity the assignment is dropped and overflowed() is set,
+ * as in the real library.
+ */
+
+#ifndef FAKE_ARDUINOJSON_H
+#define FAKE_ARDUINOJSON_H
+
+#include "Arduino.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fakejson {
+
+#define FAKEJSON_SLOT_SIZE 16
+
+struct Node {
+    enum Type { Null, Bool, Int, Float, Str, Object, Array } type = Null;
+    bool boolean = false;
+    int64_t integer = 0;
+    double real = 0;
+    std::string str;
+    bool linked = false;  // String stored by pointer (no pool cost)
+    struct Member {
+        std::string key;
+        bool keyLinked;
+        Node* value;
+    };
+    std::vector<Member> members;  // Object members or array elements (empty key)
+
+    Node* find(const std::string& key) const {
+        for (const Member& member : members) {
+            if (member.key == key) {
+                return member.value;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class Pool {
+private:
+    size_t _capacity;
+    size_t _used = 0;
+    bool _overflowed = false;
+    std::vector<std::unique_ptr<Node>> _nodes;
+
+public:
+    Node root;
+
+    explicit Pool(size_t capacity) : _capacity(capacity) {}
+
+    bool reserve(size_t bytes) {
+        if (_used + bytes > _capacity) {
+            _overflowed = true;
+            return false;
+        }
+        _used += bytes;
+        return true;
+    }
+
+    Node* newNode() {
+        _nodes.emplace_back(new Node());
+        return _nodes.back().get();
+    }
+
+    // Member slot (+ key copy); nullptr when the pool is exhausted
+    Node* addMember(Node* object, const std::string& key, bool keyLinked) {
+        if (!reserve(FAKEJSON_SLOT_SIZE + (keyLinked ? 0 : key.size() + 1))) {
+            return nullptr;
+        }
+        Node* value = newNode();
+        object->members.push_back({ key, keyLinked, value });
+        return value;
+    }
+
+    void clear() {
+        root = Node();
+        _nodes.clear();
+        _used = 0;
+        _overflowed = false;
+    }
+
+    size_t capacity() const { return _capacity; }
+    size_t used() const { return _used; }
+    bool overflowed() const { return _overflowed; }
+};
+
+inline bool setString(Pool* pool, Node* node, const std::string& value, bool linked) {
+    if (!linked && !pool->reserve(value.size() + 1)) {
+        node->type = Node::Null;
+        return false;
+    }
+    node->type = Node::Str;
+    node->str = value;
+    node->linked = linked;
+    return true;
+}
+
+// Deep copy between (or within) documents; linked strings stay linked
+inline bool copyNode(Pool* pool, Node* dest, const Node* src) {
+    if (src->type == Node::Str) {
+        return setString(pool, dest, src->str, src->linked);
+    }
+    if (src->type != Node::Object && src->type != Node::Array) {
+        *dest = *src;
+        dest->members.clear();
+        return true;
+    }
+
+    Node copy;
+    copy.type = src->type;
+    std::vector<Node::Member> members = src->members;  // src may be inside dest
+    *dest = copy;
+    for (const Node::Member& member : members) {
+        Node* value = pool->addMember(dest, member.key, member.keyLinked);
+        if (!value || !copyNode(pool, value, member.value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void formatNumber(std::string& out, double value) {
+    if (std::isnan(value) || std::isinf(value)) {
+        out += "null";
+        return;
+    }
+    char buf[48];
+    double magnitude = std::fabs(value);
+    if (magnitude >= 1e7 || (magnitude > 0 && magnitude < 1e-5)) {
+        snprintf(buf, sizeof(buf), "%.9e", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%.9f", value);
+    }
+
+    // Drop trailing zeros of the fraction, as ArduinoJson does
+    std::string text = buf;
+    size_t exponent = text.find('e');
+    std::string mantissa = text.substr(0, exponent);
+    std::string suffix = exponent == std::string::npos ? "" : text.substr(exponent);
+    if (mantissa.find('.') != std::string::npos) {
+        while (mantissa.back() == '0') mantissa.pop_back();
+        if (mantissa.back() == '.') mantissa.pop_back();
+    }
+    if (!suffix.empty()) {
+        int e = atoi(suffix.c_str() + 1);
+        suffix = "e" + std::to_string(e);
+    }
+    out += mantissa + suffix;
+}
+
+inline void escapeString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: out += c;
+        }
+    }
+    out += '"';
+}
+
+inline void serialize(std::string& out, const Node* node) {
+    switch (node->type) {
+        case Node::Null: out += "null"; break;
+        case Node::Bool: out += node->boolean ? "true" : "false"; break;
+        case Node::Int: out += std::to_string(node->integer); break;
+        case Node::Float: formatNumber(out, node->real); break;
+        case Node::Str: escapeString(out, node->str); break;
+        case Node::Object:
+        case Node::Array: {
+            bool object = node->type == Node::Object;
+            out += object ? '{' : '[';
+            for (size_t i = 0; i < node->members.size(); i++) {
+                if (i > 0) out += ',';
+                if (object) {
+                    escapeString(out, node->members[i].key);
+                    out += ':';
+                }
+                serialize(out, node->members[i].value);
+            }
+            out += object ? '}' : ']';
+            break;
+        }
+    }
+}
+
+class Parser {
+private:
+    Pool* _pool;
+    const char* _p;
+    const char* _end;
+
+    void skipSpace() {
+        while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t')) _p++;
+    }
+
+    bool parseString(std::string& out) {
+        if (_p >= _end || *_p != '"') return false;
+        _p++;
+        while (_p < _end && *_p != '"') {
+            char c = *_p++;
+            if (c == '\\' && _p < _end) {
+                char e = *_p++;
+                switch (e) {
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    default: c = e;
+                }
+            }
+            out += c;
+        }
+        if (_p >= _end) return false;
+        _p++;
+        return true;
+    }
+
+public:
+    bool noMemory = false;
+
+    Parser(Pool* pool, const char* begin, const char* end) : _pool(pool), _p(begin), _end(end) {}
+
+    bool parseValue(Node* node) {
+        skipSpace();
+        if (_p >= _end) return false;
+
+        if (*_p == '{' || *_p == '[') {
+            bool object = *_p == '{';
+            char close = object ? '}' : ']';
+            node->type = object ? Node::Object : Node::Array;
+            _p++;
+            skipSpace();
+            if (_p < _end && *_p == close) {
+                _p++;
+                return true;
+            }
+            while (true) {
+                std::string key;
+                skipSpace();
+                if (object) {
+                    if (!parseString(key)) return false;
+                    skipSpace();
+                    if (_p >= _end || *_p++ != ':') return false;
+                }
+                Node* value = _pool->addMember(node, key, false);
+                if (!value) {
+                    noMemory = true;
+                    return false;
+                }
+                if (!parseValue(value)) return false;
+                skipSpace();
+                if (_p < _end && *_p == ',') {
+                    _p++;
+                    continue;
+                }
+                if (_p < _end && *_p == close) {
+                    _p++;
+                    return true;
+                }
+                return false;
+            }
+        }
+        if (*_p == '"') {
+            std::string value;
+            if (!parseString(value)) return false;
+            if (!setString(_pool, node, value, false)) {
+                noMemory = true;
+                return false;
+            }
+            return true;
+        }
+        if (_end - _p >= 4 && strncmp(_p, "true", 4) == 0) {
+            node->type = Node::Bool;
+            node->boolean = true;
+            _p += 4;
+            return true;
+        }
+        if (_end - _p >= 5 && strncmp(_p, "false", 5) == 0) {
+            node->type = Node::Bool;
+            node->boolean = false;
+            _p += 5;
+            return true;
+        }
+        if (_end - _p >= 4 && strncmp(_p, "null", 4) == 0) {
+            node->type = Node::Null;
+            _p += 4;
+            return true;
+        }
+
+        std::string number;
+        while (_p < _end && strchr("+-0123456789.eE", *_p)) number += *_p++;
+        if (number.empty()) return false;
+        if (number.find_first_of(".eE") == std::string::npos) {
+            node->type = Node::Int;
+            node->integer = atoll(number.c_str());
+        } else {
+            node->type = Node::Float;
+            node->real = atof(number.c_str());
+        }
+        return true;
+    }
+
+    bool atEnd() {
+        skipSpace();
+        return _p >= _end || *_p == '\0';
+    }
+};
+
+} // namespace fakejson
+
+class JsonObject;
+class MemberProxy;
+
+struct JsonString {
+    const char* value;
+    const char* c_str() const { return value; }
+};
+
+class JsonVariant {
+protected:
+    fakejson::Pool* _pool;
+    fakejson::Node* _node;
+
+    template <typename T>
+    static T numberAs(const fakejson::Node* node) {
+        if (!node) return T();
+        switch (node->type) {
+            case fakejson::Node::Int: return (T)node->integer;
+            case fakejson::Node::Float: return (T)node->real;
+            case fakejson::Node::Bool: return (T)node->boolean;
+            default: return T();
+        }
+    }
+
+public:
+    JsonVariant() : _pool(nullptr), _node(nullptr) {}
+    JsonVariant(fakejson::Pool* pool, fakejson::Node* node) : _pool(pool), _node(node) {}
+
+    fakejson::Node* node() const { return _node; }
+    fakejson::Pool* pool() const { return _pool; }
+
+    bool isNull() const { return !_node || _node->type == fakejson::Node::Null; }
+
+    template <typename T>
+    T as() const;
+
+    template <typename T>
+    bool is() const;
+
+    template <typename T>
+    bool set(const T& value);
+
+    template <typename T>
+    T operator|(const T& fallback) const {
+        if (!_node || (_node->type != fakejson::Node::Int && _node->type != fakejson::Node::Float &&
+                       _node->type != fakejson::Node::Bool)) {
+            return fallback;
+        }
+        return numberAs<T>(_node);
+    }
+
+    const char* operator|(const char* fallback) const {
+        return _node && _node->type == fakejson::Node::Str ? _node->str.c_str() : fallback;
+    }
+
+    JsonVariant operator[](const char* key) const {
+        if (!_node || _node->type != fakejson::Node::Object) return JsonVariant();
+        return JsonVariant(_pool, _node->find(key));
+    }
+
+    bool containsKey(const char* key) const {
+        return _node && _node->type == fakejson::Node::Object && _node->find(key);
+    }
+
+    operator JsonObject() const;
+};
+
+class JsonPair {
+private:
+    const fakejson::Node::Member* _member;
+    fakejson::Pool* _pool;
+
+public:
+    JsonPair(fakejson::Pool* pool, const fakejson::Node::Member* member) : _member(member), _pool(pool) {}
+    JsonString key() const { return { _member->key.c_str() }; }
+    JsonVariant value() const { return JsonVariant(_pool, _member->value); }
+};
+
+class JsonObjectIterator {
+private:
+    fakejson::Pool* _pool;
+    const fakejson::Node::Member* _member;
+
+public:
+    JsonObjectIterator(fakejson::Pool* pool, const fakejson::Node::Member* member) : _pool(pool), _member(member) {}
+    JsonPair operator*() const { return JsonPair(_pool, _member); }
+    JsonObjectIterator& operator++() {
+        _member++;
+        return *this;
+    }
+    bool operator!=(const JsonObjectIterator& other) const { return _member != other._member; }
+};
+
+// obj["key"]: read-only until assigned, then the member is created
+class MemberProxy {
+private:
+    fakejson::Pool* _pool;
+    fakejson::Node* _object;
+    std::string _key;
+    bool _keyLinked;
+
+    fakejson::Node* existing() const { return _object ? _object->find(_key) : nullptr; }
+
+    fakejson::Node* getOrCreate() {
+        if (!_object || _object->type != fakejson::Node::Object) return nullptr;
+        fakejson::Node* node = existing();
+        return node ? node : _pool->addMember(_object, _key, _keyLinked);
+    }
+
+public:
+    MemberProxy(fakejson::Pool* pool, fakejson::Node* object, const std::string& key, bool keyLinked)
+        : _pool(pool), _object(object), _key(key), _keyLinked(keyLinked) {}
+
+    template <typename T>
+    MemberProxy& operator=(const T& value) {
+        fakejson::Node* node = getOrCreate();
+        if (node) {
+            JsonVariant(_pool, node).set(value);
+        }
+        return *this;
+    }
+
+    MemberProxy& operator=(const char* value) {
+        fakejson::Node* node = getOrCreate();
+        if (node) {
+            JsonVariant(_pool, node).set(value);
+        }
+        return *this;
+    }
+
+    JsonVariant variant() const { return JsonVariant(_pool, existing()); }
+
+    bool isNull() const { return variant().isNull(); }
+
+    template <typename T>
+    T as() const { return variant().as<T>(); }
+
+    template <typename T>
+    T operator|(const T& fallback) const { return variant() | fallback; }
+
+    const char* operator|(const char* fallback) const { return variant() | fallback; }
+
+    JsonVariant operator[](const char* key) const { return variant()[key]; }
+
+    bool containsKey(const char* key) const { return variant().containsKey(key); }
+
+    operator JsonObject() const;
+
+    JsonObject createNestedObject(const char* key);
+};
+
+class JsonObject {
+private:
+    fakejson::Pool* _pool;
+    fakejson::Node* _node;
+
+public:
+    JsonObject() : _pool(nullptr), _node(nullptr) {}
+    JsonObject(fakejson::Pool* pool, fakejson::Node* node)
+        : _pool(pool), _node(node && node->type == fakejson::Node::Object ? node : nullptr) {}
+
+    fakejson::Node* node() const { return _node; }
+    fakejson::Pool* pool() const { return _pool; }
+
+    bool isNull() const { return !_node; }
+    size_t size() const { return _node ? _node->members.size() : 0; }
+
+    MemberProxy operator[](const char* key) const { return MemberProxy(_pool, _node, key, true); }
+    MemberProxy operator[](const String& key) const { return MemberProxy(_pool, _node, key.c_str(), false); }
+
+    JsonObject createNestedObject(const char* key) const {
+        return MemberProxy(_pool, _node, key, true).createNestedObject(key);
+    }
+
+    bool containsKey(const char* key) const { return _node && _node->find(key); }
+
+    JsonObjectIterator begin() const {
+        return JsonObjectIterator(_pool, _node ? _node->members.data() : nullptr);
+    }
+    JsonObjectIterator end() const {
+        return JsonObjectIterator(_pool, _node ? _node->members.data() + _node->members.size() : nullptr);
+    }
+};
+
+inline JsonVariant::operator JsonObject() const {
+    return JsonObject(_pool, _node);
+}
+
+inline MemberProxy::operator JsonObject() const {
+    return JsonObject(_pool, existing());
+}
+
+inline JsonObject MemberProxy::createNestedObject(const char*) {
+    fakejson::Node* node = getOrCreate();
+    if (!node) return JsonObject();
+    *node = fakejson::Node();
+    node->type = fakejson::Node::Object;
+    return JsonObject(_pool, node);
+}
+
+template <typename T>
+bool JsonVariant::set(const T& value) {
+    if (!_node) return false;
+    *_node = fakejson::Node();
+    if constexpr (std::is_same<T, bool>::value) {
+        _node->type = fakejson::Node::Bool;
+        _node->boolean = value;
+    } else if constexpr (std::is_integral<T>::value) {
+        _node->type = fakejson::Node::Int;
+        _node->integer = (int64_t)value;
+    } else if constexpr (std::is_floating_point<T>::value) {
+        _node->type = fakejson::Node::Float;
+        _node->real = (double)value;
+    } else if constexpr (std::is_same<T, String>::value) {
+        return fakejson::setString(_pool, _node, value.c_str(), false);
+    } else if constexpr (std::is_same<T, std::string>::value) {
+        return fakejson::setString(_pool, _node, value, false);
+    } else if constexpr (std::is_same<T, const char*>::value) {
+        return value ? fakejson::setString(_pool, _node, value, true) : true;
+    } else if constexpr (std::is_same<T, char*>::value) {
+        return value ? fakejson::setString(_pool, _node, value, false) : true;
+    } else if constexpr (std::is_array<T>::value) {
+        return fakejson::setString(_pool, _node, value, true);
+    } else if constexpr (std::is_same<T, JsonObject>::value || std::is_same<T, JsonVariant>::value) {
+        if (value.node()) {
+            return fakejson::copyNode(_pool, _node, value.node());
+        }
+    } else {
+        static_assert(sizeof(T) == 0, "type not supported by the ArduinoJson fake");
+    }
+    return true;
+}
+
+template <typename T>
+T JsonVariant::as() const {
+    if constexpr (std::is_same<T, JsonObject>::value) {
+        return JsonObject(_pool, _node);
+    } else if constexpr (std::is_same<T, const char*>::value) {
+        return _node && _node->type == fakejson::Node::Str ? _node->str.c_str() : nullptr;
+    } else if constexpr (std::is_same<T, String>::value) {
+        if (!_node) return String();
+        if (_node->type == fakejson::Node::Str) return String(_node->str.c_str());
+        std::string out;
+        fakejson::serialize(out, _node);
+        return String(out);
+    } else {
+        return numberAs<T>(_node);
+    }
+}
+
+template <typename T>
+bool JsonVariant::is() const {
+    if (!_node) return false;
+    if constexpr (std::is_same<T, JsonObject>::value) {
+        return _node->type == fakejson::Node::Object;
+    } else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, String>::value) {
+        return _node->type == fakejson::Node::Str;
+    } else if constexpr (std::is_same<T, bool>::value) {
+        return _node->type == fakejson::Node::Bool;
+    } else if constexpr (std::is_integral<T>::value) {
+        return _node->type == fakejson::Node::Int;
+    } else {
+        return _node->type == fakejson::Node::Int || _node->type == fakejson::Node::Float;
+    }
+}
+
+class JsonDocument {
+protected:
+    fakejson::Pool _pool;
+
+public:
+    explicit JsonDocument(size_t capacity) : _pool(capacity) {}
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    fakejson::Node* root() { return &_pool.root; }
+    fakejson::Pool* pool() { return &_pool; }
+
+    // The root becomes an object on first member access, like ArduinoJson
+    MemberProxy operator[](const char* key) {
+        if (_pool.root.type == fakejson::Node::Null) _pool.root.type = fakejson::Node::Object;
+        return MemberProxy(&_pool, &_pool.root, key, true);
+    }
+    MemberProxy operator[](const String& key) {
+        if (_pool.root.type == fakejson::Node::Null) _pool.root.type = fakejson::Node::Object;
+        return MemberProxy(&_pool, &_pool.root, key.c_str(), false);
+    }
+
+    JsonObject createNestedObject(const char* key) {
+        return (*this)[key].createNestedObject(key);
+    }
+
+    template <typename T>
+    T as() { return JsonVariant(&_pool, &_pool.root).as<T>(); }
+
+    template <typename T>
+    T to() {
+        static_assert(std::is_same<T, JsonObject>::value, "only to<JsonObject>() is faked");
+        _pool.clear();
+        _pool.root.type = fakejson::Node::Object;
+        return JsonObject(&_pool, &_pool.root);
+    }
+
+    bool isNull() { return _pool.root.type == fakejson::Node::Null; }
+    bool containsKey(const char* key) { return JsonVariant(&_pool, &_pool.root).containsKey(key); }
+    bool overflowed() const { return _pool.overflowed(); }
+    size_t memoryUsage() const { return _pool.used(); }
+    size_t capacity() const { return _pool.capacity(); }
+    void clear() { _pool.clear(); }
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {
+public:
+    StaticJsonDocument() : JsonDocument(N) {}
+};
+
+class DynamicJsonDocument : public JsonDocument {
+public:
+    explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory };
+
+    DeserializationError(Code code) : _code(code) {}
+    explicit operator bool() const { return _code != Ok; }
+    bool operator==(Code code) const { return _code == code; }
+    const char* c_str() const {
+        static const char* names[] = { "Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory" };
+        return names[_code];
+    }
+
+private:
+    Code _code;
+};
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+    doc.clear();
+    if (length == 0) return DeserializationError::EmptyInput;
+
+    fakejson::Parser parser(doc.pool(), input, input + length);
+    if (!parser.parseValue(doc.root())) {
+        doc.clear();
+        return parser.noMemory ? DeserializationError::NoMemory : DeserializationError::InvalidInput;
+    }
+    return parser.atEnd() ? DeserializationError::Ok : DeserializationError::InvalidInput;
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const uint8_t* input, size_t length) {
+    return deserializeJson(doc, (const char*)input, length);
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+    return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+inline std::string toJson(const fakejson::Node* node) {
+    std::string out;
+    fakejson::serialize(out, node);
+    return out;
+}
+
+inline size_t serializeJson(JsonDocument& doc, String& output) {
+    std::string out = toJson(doc.root());
+    output = String(out);
+    return out.size();
+}
+
+inline size_t serializeJson(JsonDocument& doc, char* output, size_t size) {
+    std::string out = toJson(doc.root());
+    if (size == 0) return 0;
+    size_t n = out.size() < size - 1 ? out.size() : size - 1;
+    memcpy(output, out.data(), n);
+    output[n] = '\0';
+    return n;
+}
+
+inline size_t serializeJson(JsonObject object, String& output) {
+    std::string out = object.node() ? toJson(object.node()) : "null";
+    output = String(out);
+    return out.size();
+}
+
+inline size_t measureJson(JsonDocument& doc) {
+    return toJson(doc.root()).size();
+}
+
+#endif // FAKE_ARDUINOJSON_H
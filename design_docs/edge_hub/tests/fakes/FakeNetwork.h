@@ -0,0 +1,112 @@
+/*
+ * Simulated MQTT brokers shared by the fake WiFiClient and PubSubClient.
+ *
+ * Brokers are addressed by host:port. Tests kill and restore them to
+ * exercise failover; publishes are routed to subscribed clients (exact
+ * topic match) and logged so tests can assert what reached each broker.
+ */
+
+#ifndef FAKE_NETWORK_H
+#define FAKE_NETWORK_H
+
+#include "Arduino.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace fake {
+
+struct Message {
+    std::string topic;
+    std::string payload;
+    bool retained;
+    unsigned long time;     // millis() when the broker received it
+    std::string clientId;
+};
+
+// Receives messages routed by a broker (implemented by PubSubClient)
+class Subscriber {
+public:
+    virtual ~Subscriber() {}
+    virtual void deliver(const std::string& topic, const std::string& payload) = 0;
+};
+
+struct Broker {
+    bool up = true;
+    unsigned long epoch = 0;           // Bumped on every restart, drops old sessions
+    unsigned long downSince = 0;
+    unsigned long connectLatency = 5;  // ms for a successful connect
+    unsigned long unreachableCost = 0; // ms a connect attempt hangs while down (0 = refused)
+    std::vector<Message> published;
+    std::map<Subscriber*, std::set<std::string>> subscriptions;
+
+    void publish(const Message& message) {
+        published.push_back(message);
+        for (auto& entry : subscriptions) {
+            if (entry.second.count(message.topic)) {
+                entry.first->deliver(message.topic, message.payload);
+            }
+        }
+    }
+
+    size_t count(const std::string& topic) const {
+        size_t n = 0;
+        for (const Message& message : published) {
+            n += message.topic == topic;
+        }
+        return n;
+    }
+};
+
+class Network {
+private:
+    std::map<std::string, Broker> _brokers;
+
+    static std::string key(const char* host, int port) {
+        return std::string(host) + ":" + std::to_string(port);
+    }
+
+public:
+    Broker& broker(const char* host, int port) {
+        return _brokers[key(host, port)];
+    }
+
+    Broker* find(const char* host, int port) {
+        auto it = _brokers.find(key(host, port));
+        return it == _brokers.end() ? nullptr : &it->second;
+    }
+
+    void kill(const char* host, int port) {
+        Broker& b = broker(host, port);
+        b.up = false;
+        b.downSince = millis();
+        b.subscriptions.clear();
+    }
+
+    void restore(const char* host, int port) {
+        Broker& b = broker(host, port);
+        b.up = true;
+        b.epoch++;
+    }
+
+    void unsubscribeAll(Subscriber* subscriber) {
+        for (auto& entry : _brokers) {
+            entry.second.subscriptions.erase(subscriber);
+        }
+    }
+
+    void reset() {
+        _brokers.clear();
+    }
+};
+
+inline Network& network() {
+    static Network instance;
+    return instance;
+}
+
+} // namespace fake
+
+#endif // FAKE_NETWORK_H
@@ -0,0 +1,179 @@
+/*
+ * Host fake of PubSubClient backed by the brokers of FakeNetwork.h.
+ *
+ * Mirrors the behaviour the library depends on: connect() opens the TCP
+ * connection through the WiFiClient (so a dead broker costs the client's
+ * connect timeout, not the socket timeout), a dead broker is noticed after
+ * 1.5x keepalive (or on the first failed write), publishes larger than the buffer are refused
+ * and loop() handles at most one incoming message per call.
+ */
+
+#ifndef FAKE_PUBSUBCLIENT_H
+#define FAKE_PUBSUBCLIENT_H
+
+#include "Arduino.h"
+#include "FakeNetwork.h"
+#include "WiFi.h"
+
+#include <deque>
+#include <functional>
+#include <utility>
+
+#define MQTT_MAX_HEADER_SIZE 5
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+class PubSubClient : public fake::Subscriber {
+private:
+    std::string _host;
+    int _port = 0;
+    std::string _clientId;
+    uint16_t _bufferSize = 256;
+    uint16_t _keepAlive = 15;
+    uint16_t _socketTimeout = 15;  // Only bounds the wait for CONNACK, not the TCP connect
+    WiFiClient* _client = nullptr;
+    bool _connected = false;
+    unsigned long _epoch = 0;
+    int _state = MQTT_DISCONNECTED;
+    std::deque<std::pair<std::string, std::string>> _inbox;
+    std::function<void(char*, uint8_t*, unsigned int)> _callback;
+
+    fake::Broker* broker() {
+        return fake::network().find(_host.c_str(), _port);
+    }
+
+    void drop() {
+        _connected = false;
+        _state = MQTT_DISCONNECTED;
+        _inbox.clear();
+        fake::network().unsubscribeAll(this);
+    }
+
+public:
+    ~PubSubClient() { fake::network().unsubscribeAll(this); }
+
+    PubSubClient& setClient(WiFiClient& client) {
+        _client = &client;
+        return *this;
+    }
+    PubSubClient& setServer(const char* host, uint16_t port) {
+        _host = host;
+        _port = port;
+        return *this;
+    }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) {
+        _callback = callback;
+        return *this;
+    }
+    bool setBufferSize(uint16_t size) {
+        _bufferSize = size;
+        return true;
+    }
+    uint16_t getBufferSize() { return _bufferSize; }
+    PubSubClient& setKeepAlive(uint16_t keepAlive) {
+        _keepAlive = keepAlive;
+        return *this;
+    }
+    PubSubClient& setSocketTimeout(uint16_t timeout) {
+        _socketTimeout = timeout;
+        return *this;
+    }
+    uint16_t getKeepAlive() { return _keepAlive; }
+    uint16_t getSocketTimeout() { return _socketTimeout; }
+
+    bool connect(const char* id, const char*, const char*) {
+        if (_connected) {
+            drop();
+        }
+
+        // Like PubSubClient: the TCP connect uses the WiFiClient's own timeout
+        fake::Broker* b = broker();
+        if (!_client || !_client->connect(_host.c_str(), _port)) {
+            _state = MQTT_CONNECT_FAILED;
+            return false;
+        }
+
+        _clientId = id;
+        _epoch = b->epoch;
+        _connected = true;
+        _state = MQTT_CONNECTED;
+        return true;
+    }
+
+    void disconnect() { drop(); }
+
+    bool connected() {
+        if (!_connected) {
+            return false;
+        }
+        fake::Broker* b = broker();
+        if (b->up && b->epoch == _epoch) {
+            return true;
+        }
+        // Keepalive timeout (restarted broker: the old socket gets reset)
+        if (b->up || millis() - b->downSince >= (unsigned long)_keepAlive * 1500) {
+            drop();
+        }
+        return _connected;
+    }
+
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        if (!connected()) {
+            return false;
+        }
+        size_t length = strlen(payload);
+        if (MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + length > _bufferSize) {
+            return false;
+        }
+        fake::Broker* b = broker();
+        if (!b->up) {
+            drop();  // Write error
+            return false;
+        }
+        b->publish({ topic, payload, retained, millis(), _clientId });
+        return true;
+    }
+
+    bool subscribe(const char* topic, uint8_t = 0) {
+        if (!connected()) {
+            return false;
+        }
+        broker()->subscriptions[this].insert(topic);
+        return true;
+    }
+
+    bool unsubscribe(const char* topic) {
+        if (!connected()) {
+            return false;
+        }
+        broker()->subscriptions[this].erase(topic);
+        return true;
+    }
+
+    bool loop() {
+        if (!connected()) {
+            return false;
+        }
+        if (!_inbox.empty()) {
+            std::pair<std::string, std::string> message = _inbox.front();
+            _inbox.pop_front();
+            if (_callback) {
+                std::vector<char> topic(message.first.begin(), message.first.end());
+                topic.push_back('\0');
+                _callback(topic.data(), (uint8_t*)message.second.data(), (unsigned int)message.second.size());
+            }
+        }
+        return true;
+    }
+
+    int state() { return _state; }
+
+    void deliver(const std::string& topic, const std::string& payload) override {
+        _inbox.emplace_back(topic, payload);
+    }
+};
+
+#endif // FAKE_PUBSUBCLIENT_H
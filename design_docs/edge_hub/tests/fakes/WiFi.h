@@ -0,0 +1,54 @@
+/*
+ * Host fake of the ESP32 WiFi library: always associated, TCP connects
+ * go to the simulated brokers of FakeNetwork.h.
+ */
+
+#ifndef FAKE_WIFI_H
+#define FAKE_WIFI_H
+
+#include "Arduino.h"
+#include "FakeNetwork.h"
+
+#define WL_CONNECTED 3
+#define WIFI_CLIENT_DEF_CONN_TIMEOUT_MS 3000
+
+class WiFiClass {
+public:
+    void begin(const char*, const char*) {}
+    int status() { return WL_CONNECTED; }
+    String localIP() { return "192.168.1.50"; }
+    int RSSI() { return -61; }
+};
+
+inline WiFiClass WiFi;
+
+class WiFiClient {
+private:
+    unsigned long _timeout = WIFI_CLIENT_DEF_CONN_TIMEOUT_MS;
+    bool _connected = false;
+
+public:
+    int connect(const char* host, uint16_t port) {
+        return connect(host, port, (int32_t)_timeout);
+    }
+
+    // A dead broker costs min(unreachableCost, timeout) ms
+    int connect(const char* host, uint16_t port, int32_t timeout) {
+        fake::Broker* broker = fake::network().find(host, port);
+        if (!broker || !broker->up) {
+            unsigned long cost = broker ? broker->unreachableCost : 0;
+            fake::advance(min(cost, (unsigned long)timeout));
+            _connected = false;
+            return 0;
+        }
+        fake::advance(broker->connectLatency);
+        _connected = true;
+        return 1;
+    }
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    uint8_t connected() { return _connected; }
+    void stop() { _connected = false; }
+};
+
+#endif // FAKE_WIFI_H
@@ -0,0 +1,311 @@
+/*
+ * Arduino library: broker selection, failover counting and the offline
+ * telemetry buffer, against simulated edge and cloud brokers.
+ */
+
+#include "SmartFarmIoT.h"
+#include "TestSupport.h"
+
+#include <memory>
+
+static const char* EDGE = "edge.local";
+static const char* CLOUD = "cloud.example.com";
+static const char* DEVICE_ID = "ESP32_FAILOVER_01";
+
+static const std::string TELEMETRY_TOPIC = std::string("farm/") + DEVICE_ID + "/telemetry";
+static const std::string STATUS_TOPIC = std::string("farm/") + DEVICE_ID + "/status";
+
+struct Node {
+    std::unique_ptr<SmartFarmIoT> iot;
+    int nextSeq = 0;
+    unsigned long lastSend = 0;
+
+    Node() {
+        fake::network().reset();
+        fake::network().broker(EDGE, 1883);
+        fake::network().broker(CLOUD, 1883);
+
+        iot.reset(new SmartFarmIoT(DEVICE_ID, "token"));
+        iot->addBroker(EDGE);
+        iot->addBroker(CLOUD);
+        iot->begin("farm-wifi", "secret");
+        lastSend = millis();
+    }
+
+    void sendTelemetry() {
+        StaticJsonDocument<64> sensors;
+        sensors["seq"] = nextSeq++;
+        iot->sendTelemetry(sensors.as<JsonObject>());
+    }
+
+    // Run loop() every 10 ms, publishing telemetry every 5 s
+    void run(unsigned long ms) {
+        unsigned long end = millis() + ms;
+        while (millis() < end) {
+            iot->loop();
+            if (millis() - lastSend >= 5000) {
+                sendTelemetry();
+                lastSend = millis();
+            }
+            delay(10);
+        }
+    }
+
+    // Run until the device is on the given broker; returns the time taken
+    unsigned long runUntilActive(const char* host, unsigned long limit) {
+        unsigned long start = millis();
+        std::string want = std::string(host) + ":1883";
+        while (millis() - start < limit && iot->getActiveBroker() != want.c_str()) {
+            run(10);
+        }
+        return millis() - start;
+    }
+};
+
+static std::vector<int> telemetrySeqs(const char* host) {
+    std::vector<int> seqs;
+    for (const fake::Message& message : fake::network().broker(host, 1883).published) {
+        if (message.topic != TELEMETRY_TOPIC) {
+            continue;
+        }
+        StaticJsonDocument<512> doc;
+        deserializeJson(doc, message.payload.c_str());
+        seqs.push_back(doc["sensors"]["seq"] | -1);
+    }
+    return seqs;
+}
+
+static bool lastStatus(const char* host, StaticJsonDocument<512>& doc) {
+    const std::vector<fake::Message>& published = fake::network().broker(host, 1883).published;
+    for (auto it = published.rbegin(); it != published.rend(); ++it) {
+        if (it->topic.size() > 7 && it->topic.compare(it->topic.size() - 7, 7, "/status") == 0) {
+            return !deserializeJson(doc, it->payload.c_str());
+        }
+    }
+    return false;
+}
+
+TEST(connects_to_preferred_broker_and_reports_it) {
+    Node node;
+    CHECK(node.iot->isConnected());
+    CHECK(node.iot->getActiveBroker() == "edge.local:1883");
+    CHECK_EQ(node.iot->getFailoverCount(), 0);
+
+    // Status must fit the MQTT buffer, or the broker fields never reach the platform
+    StaticJsonDocument<512> status;
+    CHECK(lastStatus(EDGE, status));
+    CHECK(String(status["broker"] | "") == "edge.local:1883");
+    CHECK_EQ(status["failover_count"] | -1, 0);
+}
+
+TEST(fails_over_within_timeout_without_losing_telemetry) {
+    Node node;
+    node.run(12000);
+    size_t beforeKill = telemetrySeqs(EDGE).size();
+    CHECK(beforeKill >= 2);
+
+    fake::network().kill(EDGE, 1883);
+    unsigned long took = node.runUntilActive(CLOUD, 60000);
+    CHECK(took <= DEFAULT_FAILOVER_TIMEOUT);
+    CHECK_EQ(node.iot->getFailoverCount(), 1);
+
+    // The switch is already counted in the status sent on connect
+    StaticJsonDocument<512> status;
+    CHECK(lastStatus(CLOUD, status));
+    CHECK(String(status["broker"] | "") == "cloud.example.com:1883");
+    CHECK_EQ(status["failover_count"] | -1, 1);
+
+    // Every reading reaches exactly one broker, in order
+    node.run(20000);
+    std::vector<int> seqs = telemetrySeqs(EDGE);
+    std::vector<int> cloud = telemetrySeqs(CLOUD);
+    seqs.insert(seqs.end(), cloud.begin(), cloud.end());
+    CHECK_EQ(seqs.size(), (size_t)node.nextSeq);
+    for (size_t i = 0; i < seqs.size(); i++) {
+        CHECK_EQ(seqs[i], (int)i);
+    }
+}
+
+TEST(returns_to_preferred_broker_after_recovery) {
+    Node node;
+    fake::network().kill(EDGE, 1883);
+    node.runUntilActive(CLOUD, 60000);
+    node.run(5000);
+
+    fake::network().restore(EDGE, 1883);
+    unsigned long took = node.runUntilActive(EDGE, 120000);
+    CHECK(took <= DEFAULT_BROKER_PROBE_INTERVAL + 1000);
+    CHECK_EQ(node.iot->getFailoverCount(), 2);
+
+    StaticJsonDocument<512> status;
+    CHECK(lastStatus(EDGE, status));
+    CHECK_EQ(status["failover_count"] | -1, 2);
+}
+
+TEST(probes_are_bounded_by_probe_timeout) {
+    Node node;
+    fake::Broker& edge = fake::network().broker(EDGE, 1883);
+    fake::network().kill(EDGE, 1883);
+    edge.unreachableCost = 10000;  // Blackholed: SYNs are never answered
+
+    node.runUntilActive(CLOUD, 60000);
+
+    // Over several probe intervals, no single loop() blocks longer than one probe
+    unsigned long worst = 0;
+    unsigned long end = millis() + 3 * DEFAULT_BROKER_PROBE_INTERVAL;
+    while (millis() < end) {
+        unsigned long before = millis();
+        node.iot->loop();
+        worst = max(worst, millis() - before);
+        delay(10);
+    }
+    CHECK(worst > 0);  // A probe did run
+    CHECK(worst <= DEFAULT_PROBE_TIMEOUT);
+    CHECK(node.iot->getActiveBroker() == "cloud.example.com:1883");
+}
+
+TEST(blackholed_brokers_fail_over_within_timeout) {
+    const char* RELAY = "relay.local";
+    const unsigned long timeout = 6000;
+    fake::network().reset();
+    fake::Broker& edge = fake::network().broker(EDGE, 1883);
+    fake::Broker& relay = fake::network().broker(RELAY, 1883);
+    fake::network().broker(CLOUD, 1883);
+    relay.unreachableCost = 60000;  // SYNs never answered: only the connect timeout ends it
+    edge.unreachableCost = 60000;
+    fake::network().kill(RELAY, 1883);
+
+    SmartFarmIoT iot(DEVICE_ID, "token");
+    iot.addBroker(EDGE);
+    iot.addBroker(RELAY);
+    iot.addBroker(CLOUD);
+    iot.setFailoverTimeout(timeout);
+    iot.begin("farm-wifi", "secret");
+    CHECK(iot.getActiveBroker() == "edge.local:1883");
+
+    fake::network().kill(EDGE, 1883);
+    unsigned long start = millis();
+    while (millis() - start < 60000 && iot.getActiveBroker() != "cloud.example.com:1883") {
+        iot.loop();
+        delay(10);
+    }
+    CHECK(iot.getActiveBroker() == "cloud.example.com:1883");
+    CHECK(millis() - start <= timeout);
+}
+
+TEST(status_fits_with_long_ids) {
+    const char* LONG_HOST = "edge-hub-greenhouse-7.farm-3f2c9a1e.internal";
+    const char* UUID = "3f2c9a1e-7b4d-4c1a-9e8f-0a1b2c3d4e5f";
+    fake::network().reset();
+    fake::network().broker(LONG_HOST, 1883);
+
+    SmartFarmIoT iot(UUID, "token");
+    iot.addBroker(LONG_HOST);
+    iot.begin("farm-wifi", "secret");
+
+    StaticJsonDocument<512> status;
+    CHECK(lastStatus(LONG_HOST, status));
+    CHECK(String(status["device_id"] | "") == UUID);
+    CHECK(String(status["broker"] | "") == (std::string(LONG_HOST) + ":1883").c_str());
+    CHECK_EQ(status["failover_count"] | -1, 0);
+}
+
+TEST(no_probes_while_on_primary) {
+    Node node;
+    fake::Broker& cloud = fake::network().broker(CLOUD, 1883);
+    fake::network().kill(CLOUD, 1883);
+    cloud.unreachableCost = 10000;
+
+    unsigned long end = millis() + 3 * DEFAULT_BROKER_PROBE_INTERVAL;
+    while (millis() < end) {
+        unsigned long before = millis();
+        node.iot->loop();
+        CHECK_EQ(millis() - before, 0);
+        delay(10);
+    }
+}
+
+TEST(reconnecting_to_same_broker_is_not_a_failover) {
+    Node node;
+    fake::network().kill(EDGE, 1883);
+    fake::network().kill(CLOUD, 1883);
+    node.run(20000);
+    CHECK(!node.iot->isConnected());
+    CHECK(node.iot->getActiveBroker() == "");
+
+    fake::network().restore(EDGE, 1883);
+    node.runUntilActive(EDGE, 60000);
+    CHECK_EQ(node.iot->getFailoverCount(), 0);
+}
+
+TEST(offline_buffer_keeps_newest_in_order) {
+    Node node;
+    node.run(6000);
+    int firstOffline = node.nextSeq;
+
+    fake::network().kill(EDGE, 1883);
+    fake::network().kill(CLOUD, 1883);
+    node.run(5000 * (TELEMETRY_BUFFER_SIZE + 4));
+    int sentOffline = node.nextSeq - firstOffline;
+    CHECK(sentOffline > TELEMETRY_BUFFER_SIZE);
+
+    fake::network().restore(CLOUD, 1883);
+    node.runUntilActive(CLOUD, 60000);
+    CHECK_EQ(node.iot->getFailoverCount(), 1);
+
+    // The oldest readings were dropped; the rest arrive oldest first
+    std::vector<int> replayed = telemetrySeqs(CLOUD);
+    CHECK_EQ(replayed.size(), (size_t)TELEMETRY_BUFFER_SIZE);
+    for (size_t i = 0; i < replayed.size(); i++) {
+        CHECK_EQ(replayed[i], node.nextSeq - TELEMETRY_BUFFER_SIZE + (int)i);
+    }
+}
+
+TEST(offline_buffer_is_bounded_by_bytes) {
+    Node node;
+    fake::network().kill(EDGE, 1883);
+    fake::network().kill(CLOUD, 1883);
+    for (int i = 0; i < 3000 && node.iot->isConnected(); i++) {
+        node.iot->loop();  // Without run(): no small messages in the buffer
+        delay(10);
+    }
+    CHECK(!node.iot->isConnected());
+
+    // Large messages: fewer than TELEMETRY_BUFFER_SIZE fit the buffer
+    static const std::string padding(700, 'x');
+    for (int i = 0; i < TELEMETRY_BUFFER_SIZE; i++) {
+        StaticJsonDocument<64> sensors;
+        sensors["seq"] = node.nextSeq++;
+        sensors["note"] = padding.c_str();
+        CHECK(!node.iot->sendTelemetry(sensors.as<JsonObject>()));
+    }
+
+    fake::network().restore(EDGE, 1883);
+    for (int i = 0; i < 6000 && !node.iot->isConnected(); i++) {
+        node.iot->loop();
+        delay(10);
+    }
+
+    std::vector<int> replayed;
+    size_t size = 0;
+    for (const fake::Message& message : fake::network().broker(EDGE, 1883).published) {
+        if (message.topic == TELEMETRY_TOPIC) {
+            StaticJsonDocument<2048> doc;
+            CHECK(!deserializeJson(doc, message.payload.c_str()));
+            replayed.push_back(doc["sensors"]["seq"] | -1);
+            size = message.payload.size() + 1;
+        }
+    }
+    CHECK(size > 0);
+    if (size == 0) {
+        return;
+    }
+    size_t fits = TELEMETRY_BUFFER_BYTES / size;
+    CHECK(fits < (size_t)TELEMETRY_BUFFER_SIZE);
+    CHECK_EQ(replayed.size(), fits);
+    for (size_t i = 0; i < replayed.size(); i++) {
+        CHECK_EQ(replayed[i], node.nextSeq - (int)fits + (int)i);
+    }
+}
+
+TEST_MAIN()
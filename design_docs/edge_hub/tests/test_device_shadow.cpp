@@ -0,0 +1,152 @@
+/*
+ * DeviceShadow: merging updates, liveness, command tracking, the load
+ * factor limit, and consistent snapshots while the writer is running.
+ */
+
+#include "DeviceShadow.h"
+#include "TestSupport.h"
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+
+TEST(telemetry_is_merged_per_sensor) {
+    DeviceShadow shadow(64);
+    ShadowSensor first[] = { { "temperature", 28.5 }, { "humidity", 65.0 } };
+    ShadowSensor second[] = { { "humidity", 70.0 }, { "soil_moisture", 41.0 } };
+
+    CHECK(shadow.updateTelemetry("ESP32_001", 100, first, 2, 3.7f, -65));
+    CHECK(shadow.updateTelemetry("ESP32_001", 105, second, 2));
+
+    DeviceShadowState state;
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK(strcmp(state.deviceId, "ESP32_001") == 0);
+    CHECK_EQ(state.sensorCount, 3);
+    CHECK_EQ(state.sensors[0].value, 28.5);
+    CHECK_EQ(state.sensors[1].value, 70.0);
+    CHECK(strcmp(state.sensors[2].name, "soil_moisture") == 0);
+    CHECK_EQ(state.telemetryTime, 105);
+    CHECK_NEAR(state.batteryVoltage, 3.7, 1e-6);  // Not reported in the second message
+    CHECK_EQ(state.rssi, -65);
+
+    CHECK(!shadow.read("ESP32_002", state));
+    CHECK_EQ(shadow.size(), 1);
+}
+
+TEST(liveness_follows_heartbeat_and_status) {
+    DeviceShadow shadow(64);
+    shadow.setHeartbeatTimeout(30);
+
+    DeviceShadowState state;
+    CHECK(shadow.updateStatus("ESP32_001", "online", 60, "1.0.0", 1000));
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK(shadow.isOnline(state, 1029));
+    CHECK(!shadow.isOnline(state, 1031));
+
+    CHECK(shadow.updateStatus("ESP32_001", "offline", 61, nullptr, 1032));
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK(!shadow.isOnline(state, 1032));
+    CHECK(strcmp(state.firmwareVersion, "1.0.0") == 0);
+
+    // Telemetry implies the device is back
+    ShadowSensor sensor = { "temperature", 25.0 };
+    CHECK(shadow.updateTelemetry("ESP32_001", 1040, &sensor, 1));
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK(shadow.isOnline(state, 1041));
+}
+
+TEST(command_response_matches_request_id) {
+    DeviceShadow shadow(64);
+    DeviceShadowState state;
+
+    CHECK(!shadow.commandResponse("ESP32_001", "req-1", true, 10));  // Unknown device
+
+    CHECK(shadow.commandSent("ESP32_001", "req-1", "set_relay", 10));
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK_EQ(state.commandState, COMMAND_PENDING);
+
+    CHECK(!shadow.commandResponse("ESP32_001", "req-0", true, 11));  // Stale response
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK_EQ(state.commandState, COMMAND_PENDING);
+    CHECK_EQ(state.lastSeen, 11);
+
+    CHECK(shadow.commandResponse("ESP32_001", "req-1", false, 12));
+    CHECK(shadow.read("ESP32_001", state));
+    CHECK_EQ(state.commandState, COMMAND_ERROR);
+    CHECK_EQ(state.commandAnsweredAt, 12);
+}
+
+TEST(table_stops_at_seven_eighths) {
+    DeviceShadow shadow(16);
+    CHECK_EQ(shadow.capacity(), 16);
+
+    ShadowSensor sensor = { "temperature", 1.0 };
+    for (int i = 0; i < 14; i++) {
+        CHECK(shadow.updateTelemetry(("ESP32_" + std::to_string(i)).c_str(), i, &sensor, 1));
+    }
+    CHECK(!shadow.updateTelemetry("ESP32_14", 14, &sensor, 1));
+    CHECK_EQ(shadow.size(), 14);
+
+    // Every device is still reachable through its probe chain
+    DeviceShadowState state;
+    for (int i = 0; i < 14; i++) {
+        CHECK(shadow.read(("ESP32_" + std::to_string(i)).c_str(), state));
+        CHECK_EQ(state.telemetryTime, i);
+    }
+    CHECK(shadow.updateTelemetry("ESP32_3", 100, &sensor, 1));  // Existing devices still update
+}
+
+TEST(snapshots_are_never_torn) {
+    DeviceShadow shadow(256);
+    const int devices = 100;
+    std::atomic<bool> done(false);
+    std::atomic<long> torn(0);
+
+    ShadowSensor sensors[SHADOW_MAX_SENSORS];
+    for (int s = 0; s < SHADOW_MAX_SENSORS; s++) {
+        snprintf(sensors[s].name, sizeof(sensors[s].name), "sensor_%d", s);
+        sensors[s].value = 0;
+    }
+    for (int d = 0; d < devices; d++) {
+        shadow.updateTelemetry(("ESP32_" + std::to_string(d)).c_str(), 0, sensors, SHADOW_MAX_SENSORS);
+    }
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&, r]() {
+            DeviceShadowState state;
+            int d = r;
+            while (!done.load(std::memory_order_relaxed)) {
+                d = (d + 7) % devices;
+                if (!shadow.read(("ESP32_" + std::to_string(d)).c_str(), state)) {
+                    torn++;
+                    continue;
+                }
+                // The writer sets every sensor and the timestamp to the same value
+                for (int s = 0; s < SHADOW_MAX_SENSORS; s++) {
+                    if (state.sensors[s].value != (double)state.telemetryTime) {
+                        torn++;
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int round = 1; round <= 2000; round++) {
+        for (int s = 0; s < SHADOW_MAX_SENSORS; s++) {
+            sensors[s].value = round;
+        }
+        for (int d = 0; d < devices; d++) {
+            shadow.updateTelemetry(("ESP32_" + std::to_string(d)).c_str(), round, sensors, SHADOW_MAX_SENSORS);
+        }
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK_EQ(torn.load(), 0);
+}
+
+TEST_MAIN()
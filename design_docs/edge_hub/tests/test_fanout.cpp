@@ -0,0 +1,116 @@
+/*
+ * Arduino library: farm/group command fan-out on a simulated fleet.
+ * Every targeted device answers exactly once, within the jitter window,
+ * and responses are spread out instead of arriving as one burst.
+ */
+
+#include "SimulatedFleet.h"
+#include "TestSupport.h"
+
+#include <map>
+
+static SmartFarmIoT* g_restarting = nullptr;
+
+static void restartHandler(String command, JsonObject) {
+    if (command == "restart" && g_restarting) {
+        g_restarting->sendCommandResponse(g_restarting->getCurrentRequestId().c_str(), true, "Restarting...");
+        g_restarting->flushResponses();
+    }
+}
+
+TEST(farm_command_answered_once_per_device_within_jitter) {
+    const size_t devices = 200;
+    const unsigned long jitter = 2000;
+    SimulatedFleet fleet(devices, jitter);
+
+    unsigned long sent = millis();
+    fleet.publishFarm("{\"command\":\"ping\",\"request_id\":\"req-farm-1\"}");
+    fleet.run(jitter + 1000);
+
+    std::vector<FanoutResponse> responses = fleet.responses("req-farm-1");
+    CHECK_EQ(responses.size(), devices);
+
+    std::map<std::string, int> perDevice;
+    std::map<unsigned long, int> perBucket;
+    unsigned long lastAck = 0;
+    for (const FanoutResponse& response : responses) {
+        perDevice[response.deviceId]++;
+        perBucket[(response.time - sent) / 100]++;
+        lastAck = max(lastAck, response.time - sent);
+        CHECK(response.scope == "farm");
+        CHECK(response.latency <= jitter + fleet.tick);
+    }
+    CHECK_EQ(perDevice.size(), devices);
+
+    // Fleet-wide fan-out -> last ack, bounded by the jitter plus one tick
+    CHECK(lastAck <= jitter + 2 * fleet.tick);
+
+    int peak = 0;
+    for (const auto& bucket : perBucket) {
+        peak = max(peak, bucket.second);
+    }
+    CHECK(peak < (int)devices / 5);  // ~10 per 100 ms expected, never one burst
+    printf("fan-out to %zu devices: last ack after %lu ms, peak %d acks / 100 ms\n", devices, lastAck, peak);
+}
+
+TEST(device_in_several_groups_answers_once) {
+    SimulatedFleet fleet(1, 500);
+    SmartFarmIoT& device = *fleet.devices[0];
+    CHECK(device.joinGroup("zone_a"));
+    CHECK(device.joinGroup("zone_b"));
+
+    // The copies of req-A arrive with another fan-out in between
+    fleet.publishGroup("zone_a", "{\"command\":\"ping\",\"request_id\":\"req-A\"}");
+    fleet.publishGroup("zone_b", "{\"command\":\"ping\",\"request_id\":\"req-B\"}");
+    fleet.publishGroup("zone_b", "{\"command\":\"ping\",\"request_id\":\"req-A\"}");
+    fleet.publishFarm("{\"command\":\"ping\",\"request_id\":\"req-A\"}");
+    fleet.run(2000);
+
+    CHECK_EQ(fleet.responses("req-A").size(), 1);
+    CHECK_EQ(fleet.responses("req-B").size(), 1);
+    CHECK(fleet.responses("req-B")[0].scope == "group:zone_b");
+}
+
+TEST(commands_without_request_id_are_not_merged) {
+    SimulatedFleet fleet(1, 1000);
+    fleet.publishFarm("{\"command\":\"ping\"}");
+    fleet.publishFarm("{\"command\":\"ping\"}");
+    fleet.run(3000);
+
+    CHECK_EQ(fleet.responses("").size(), 2);
+}
+
+TEST(flush_responses_sends_before_restart) {
+    SimulatedFleet fleet(1, 2000);
+    SmartFarmIoT& device = *fleet.devices[0];
+    g_restarting = &device;
+    device.onCommand(restartHandler);
+
+    fleet.publishFarm("{\"command\":\"restart\",\"request_id\":\"req-restart\"}");
+    fleet.run(fleet.tick);  // One loop(): the handler runs and the device would restart now
+
+    std::vector<FanoutResponse> responses = fleet.responses("req-restart");
+    CHECK_EQ(responses.size(), 1);
+    if (!responses.empty()) {
+        CHECK_EQ(responses[0].latency, 0);
+    }
+    g_restarting = nullptr;
+}
+
+TEST(platform_manages_groups_at_runtime) {
+    SimulatedFleet fleet(2, 200);
+    fleet.publish("farm/" + SimulatedFleet::deviceId(1) + "/command",
+                  "{\"command\":\"join_group\",\"request_id\":\"req-join\",\"params\":{\"group\":\"pumps\"}}");
+    fleet.run(500);
+    CHECK_EQ(fleet.responses("req-join").size(), 1);
+
+    fleet.publishGroup("pumps", "{\"command\":\"ping\",\"request_id\":\"req-pumps\"}");
+    fleet.run(1000);
+    std::vector<FanoutResponse> responses = fleet.responses("req-pumps");
+    CHECK_EQ(responses.size(), 1);
+    if (!responses.empty()) {
+        CHECK(responses[0].deviceId == SimulatedFleet::deviceId(1));
+    }
+}
+
+TEST_MAIN()
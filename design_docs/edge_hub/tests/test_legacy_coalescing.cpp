@@ -0,0 +1,151 @@
+/*
+ * Legacy library (../SmartFarmIoT.cpp): sendValue() coalescing. Off by
+ * default, so sketches that send and then sleep lose nothing. With a window,
+ * values go out as one message from loop(), from the next sendValue() after
+ * the window or when a sensor repeats, and flush() sends them right away.
+ */
+
+#include "SmartFarmIoT.h"
+#include "TestSupport.h"
+
+#include <map>
+#include <memory>
+
+static const char* SERVER = "mqtt.smartfarm-platform.com";
+static const char* DEVICE_ID = "ESP32_LEGACY_01";
+static const std::string TELEMETRY_TOPIC = std::string("farm/") + DEVICE_ID + "/telemetry";
+static const unsigned long WINDOW = 1000;
+
+struct LegacyNode {
+    std::unique_ptr<SmartFarmIoT> iot;
+
+    explicit LegacyNode(unsigned long window = WINDOW) {
+        fake::network().reset();
+        fake::network().broker(SERVER, 1883);
+        iot.reset(new SmartFarmIoT(DEVICE_ID, "secret"));
+        iot->setCoalesceWindow(window);
+        iot->begin("farm-wifi", "secret");
+        iot->loop();  // Connect
+    }
+
+    std::vector<fake::Message> telemetry() {
+        std::vector<fake::Message> found;
+        for (const fake::Message& message : fake::network().broker(SERVER, 1883).published) {
+            if (message.topic == TELEMETRY_TOPIC) {
+                found.push_back(message);
+            }
+        }
+        return found;
+    }
+
+    int64_t timestamp(size_t n) {
+        StaticJsonDocument<1024> doc;
+        std::vector<fake::Message> messages = telemetry();
+        if (n >= messages.size() || deserializeJson(doc, messages[n].payload.c_str())) {
+            return -1;
+        }
+        return doc["timestamp"].as<int64_t>();
+    }
+
+    // Sensor names and values of the nth telemetry message
+    std::map<std::string, double> sensors(size_t n) {
+        std::map<std::string, double> values;
+        StaticJsonDocument<1024> doc;
+        std::vector<fake::Message> messages = telemetry();
+        if (n < messages.size() && !deserializeJson(doc, messages[n].payload.c_str())) {
+            for (JsonPair pair : doc["sensors"].as<JsonObject>()) {
+                values[pair.key().c_str()] = pair.value().as<double>();
+            }
+        }
+        return values;
+    }
+};
+
+TEST(values_in_one_window_are_one_message) {
+    LegacyNode node;
+    fake::advance(1500);
+    unsigned long opened = millis();
+    node.iot->sendValue("temperature", 25.5f);
+    node.iot->sendValue("humidity", 60.0f);
+    node.iot->loop();
+    CHECK_EQ(node.telemetry().size(), 0);
+
+    fake::advance(WINDOW);
+    node.iot->loop();
+    CHECK_EQ(node.telemetry().size(), 1);
+    std::map<std::string, double> sensors = node.sensors(0);
+    CHECK_EQ(sensors.size(), 2);
+    CHECK_NEAR(sensors["temperature"], 25.5, 1e-6);
+    CHECK_NEAR(sensors["humidity"], 60.0, 1e-6);
+    CHECK_EQ(node.timestamp(0), (int64_t)(opened / 1000));  // When read, not when sent
+}
+
+TEST(unchanged_sketch_loses_nothing_before_sleep) {
+    LegacyNode node(SFIOT_DEFAULT_COALESCE_WINDOW);
+    node.iot->sendValue("soil_moisture", 41.0f);
+    node.iot->sendValue("battery_voltage", 3.7f);
+    // No loop() and no flush(): the node deep-sleeps right here
+    CHECK_EQ(node.telemetry().size(), 2);
+}
+
+TEST(repeated_sensor_starts_a_new_message) {
+    LegacyNode node;
+    node.iot->sendValue("temperature", 25.5f);
+    node.iot->sendValue("humidity", 60.0f);
+    node.iot->sendValue("temperature", 26.0f);  // Next reading cycle, window not over
+    CHECK_EQ(node.telemetry().size(), 1);
+    CHECK_EQ(node.sensors(0).size(), 2);
+    CHECK_NEAR(node.sensors(0)["temperature"], 25.5, 1e-6);
+
+    CHECK(node.iot->flush());
+    CHECK_EQ(node.telemetry().size(), 2);
+    CHECK_NEAR(node.sensors(1)["temperature"], 26.0, 1e-6);
+}
+
+TEST(expired_window_is_sent_by_next_value_without_loop) {
+    LegacyNode node;
+    node.iot->sendValue("temperature", 25.5f);
+    fake::advance(WINDOW + 500);  // Busy, loop() not called
+
+    node.iot->sendValue("humidity", 60.0f);
+    CHECK_EQ(node.telemetry().size(), 1);
+    CHECK_EQ(node.sensors(0).size(), 1);
+    CHECK(node.sensors(0).count("temperature"));
+
+    // humidity opened a new window
+    fake::advance(WINDOW);
+    node.iot->loop();
+    CHECK_EQ(node.telemetry().size(), 2);
+    CHECK(node.sensors(1).count("humidity"));
+}
+
+TEST(flush_before_sleep_sends_immediately) {
+    LegacyNode node;
+    node.iot->sendValue("soil_moisture", 41.0f);
+    node.iot->sendValue("battery_voltage", 3.7f);
+    CHECK(node.iot->flush());
+
+    std::vector<fake::Message> messages = node.telemetry();
+    CHECK_EQ(messages.size(), 1);
+    CHECK_EQ(node.sensors(0).size(), 2);
+    CHECK(node.iot->flush());  // Nothing left
+    CHECK_EQ(node.telemetry().size(), 1);
+}
+
+TEST(zero_window_publishes_every_value) {
+    LegacyNode node(0);
+    node.iot->sendValue("temperature", 25.5f);
+    node.iot->sendValue("temperature", 25.6f);
+    CHECK_EQ(node.telemetry().size(), 2);
+}
+
+TEST(full_window_is_sent_before_new_sensor) {
+    LegacyNode node;
+    for (int i = 0; i <= SFIOT_MAX_VALUES; i++) {
+        node.iot->sendValue(("sensor_" + std::to_string(i)).c_str(), (float)i);
+    }
+    CHECK_EQ(node.telemetry().size(), 1);
+    CHECK_EQ(node.sensors(0).size(), SFIOT_MAX_VALUES);
+}
+
+TEST_MAIN()
@@ -0,0 +1,202 @@
+/*
+ * Arduino library: SensorAggregator sampling and summaries, and the
+ * telemetry sizes derived from MAX_AGGREGATED_SENSORS (every channel fits
+ * one message, live and from the offline buffer).
+ */
+
+#include "SmartFarmAggregator.h"
+#include "TestSupport.h"
+
+#include <memory>
+
+static const char* BROKER = "edge.local";
+static const char* DEVICE_ID = "ESP32_AGGREGATOR_0123456789abcdef";  // Long (UUID-style) ids too
+static const std::string TELEMETRY_TOPIC = std::string("farm/") + DEVICE_ID + "/telemetry";
+
+static const char* CHANNEL_NAMES[MAX_AGGREGATED_SENSORS] = {
+    "pump_power_main", "pump_power_aux", "flow_rate_inlet", "flow_rate_outlet", "tank_pressure_kpa", "valve_current_a",
+};
+
+// Noisy negative values with many digits: the longest numbers in the JSON
+static float readWide() {
+    return -1234.56789f - (float)(random(1000000)) / 7.0f;
+}
+
+static int readCalls = 0;
+
+// Every third read fails, alternating NaN and the DHT error value
+static float readFlaky() {
+    readCalls++;
+    if (readCalls % 3 == 0) {
+        return readCalls % 2 ? NAN : SENSOR_ERROR_VALUE;
+    }
+    return 20.0f;
+}
+
+static float readBroken() {
+    return SENSOR_ERROR_VALUE;
+}
+
+static float readPump() {
+    return 750.0f;
+}
+
+struct AggregatorNode {
+    std::unique_ptr<SmartFarmIoT> iot;
+    SensorAggregator aggregator;
+
+    AggregatorNode() {
+        fake::network().reset();
+        fake::network().broker(BROKER, 1883);
+        iot.reset(new SmartFarmIoT(DEVICE_ID, "token"));
+        iot->addBroker(BROKER);
+        iot->begin("farm-wifi", "secret");
+    }
+
+    // Sample for ms at 1 ms loop() granularity
+    void sample(unsigned long ms) {
+        for (unsigned long t = 0; t < ms; t++) {
+            aggregator.loop();
+            fake::advanceMicros(1000);
+        }
+    }
+
+    // Summary plus the usual single-value sensors, as CompleteFarmNode sends it
+    bool send() {
+        StaticJsonDocument<512> sensors;
+        sensors["temperature"] = 28.5f;
+        sensors["humidity"] = 65.2f;
+        sensors["soil_moisture"] = 41;
+        sensors["ph"] = 6.85f;
+        sensors["tds"] = 850.5f;
+        sensors["water_level"] = 73.4f;
+        StaticJsonDocument<MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE> stats;
+        aggregator.writeSummary(sensors.as<JsonObject>(), stats.to<JsonObject>());
+        CHECK(!stats.overflowed());
+        aggregator.reset();
+        return iot->sendTelemetry(sensors.as<JsonObject>(), stats.as<JsonObject>(), 3.7f);
+    }
+
+    std::vector<std::string> telemetry() {
+        std::vector<std::string> payloads;
+        for (const fake::Message& message : fake::network().broker(BROKER, 1883).published) {
+            if (message.topic == TELEMETRY_TOPIC) {
+                payloads.push_back(message.payload);
+            }
+        }
+        return payloads;
+    }
+};
+
+TEST(every_channel_fits_one_message) {
+    AggregatorNode node;
+    for (int i = 0; i < MAX_AGGREGATED_SENSORS; i++) {
+        CHECK(node.aggregator.addChannel(CHANNEL_NAMES[i], readWide, 1000, true));
+    }
+    CHECK(!node.aggregator.addChannel("one_too_many", readWide));
+
+    node.sample(200);
+    CHECK(node.send());
+
+    std::vector<std::string> payloads = node.telemetry();
+    CHECK_EQ(payloads.size(), 1);
+    if (payloads.empty()) {
+        return;
+    }
+    CHECK(payloads[0].size() < TELEMETRY_PAYLOAD_SIZE);
+    printf("telemetry with %d channels: %zu of %d bytes\n", MAX_AGGREGATED_SENSORS, payloads[0].size(),
+           TELEMETRY_PAYLOAD_SIZE);
+
+    StaticJsonDocument<4096> doc;
+    CHECK(!deserializeJson(doc, payloads[0].c_str()));
+    for (int i = 0; i < MAX_AGGREGATED_SENSORS; i++) {
+        CHECK_EQ(doc["stats"][CHANNEL_NAMES[i]]["samples"] | 0, 200);
+        CHECK(doc["stats"][CHANNEL_NAMES[i]].containsKey("energy_wh"));
+    }
+}
+
+TEST(full_message_survives_the_offline_buffer) {
+    AggregatorNode node;
+    for (int i = 0; i < MAX_AGGREGATED_SENSORS; i++) {
+        node.aggregator.addChannel(CHANNEL_NAMES[i], readWide, 1000, true);
+    }
+
+    fake::network().kill(BROKER, 1883);
+    node.sample(200);
+    CHECK(!node.send());  // Buffered
+
+    fake::network().restore(BROKER, 1883);
+    for (int i = 0; i < 3000 && node.telemetry().empty(); i++) {
+        node.iot->loop();
+        fake::advance(10);
+    }
+    CHECK_EQ(node.telemetry().size(), 1);
+}
+
+TEST(oversized_telemetry_is_reported_not_truncated) {
+    AggregatorNode node;
+    DynamicJsonDocument sensors(8192);
+    for (int i = 0; i < 200; i++) {
+        sensors[("sensor_" + std::to_string(i)).c_str()] = i;
+    }
+    CHECK(!node.iot->sendTelemetry(sensors.as<JsonObject>()));
+    CHECK_EQ(node.telemetry().size(), 0);
+}
+
+TEST(failed_reads_are_skipped_and_counted) {
+    AggregatorNode node;
+    readCalls = 0;
+    CHECK(node.aggregator.addChannel("flaky", readFlaky, 100));
+    CHECK(node.aggregator.addChannel("broken", readBroken, 100));
+    node.sample(1000);
+
+    StaticJsonDocument<256> sensors;
+    StaticJsonDocument<MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE> stats;
+    node.aggregator.writeSummary(sensors.to<JsonObject>(), stats.to<JsonObject>());
+
+    // 100 Hz for 1 s, one read in three fails
+    int samples = stats["flaky"]["samples"] | 0;
+    int rejected = stats["flaky"]["rejected"] | 0;
+    CHECK_EQ(samples + rejected, readCalls);
+    CHECK_EQ(rejected, readCalls / 3);
+    CHECK_NEAR(stats["flaky"]["min"] | 0.0f, 20.0, 1e-6);
+    CHECK_NEAR(stats["flaky"]["mean"] | 0.0f, 20.0, 1e-6);
+    CHECK_NEAR(sensors["flaky"] | 0.0f, 20.0, 1e-6);
+
+    // A sensor that never read: no mean, but the failures are reported
+    CHECK(!sensors.containsKey("broken"));
+    CHECK_EQ(stats["broken"]["samples"] | -1, 0);
+    CHECK((stats["broken"]["rejected"] | 0) >= 99);
+    CHECK(!stats["broken"].containsKey("mean"));
+
+    node.aggregator.reset();
+    StaticJsonDocument<MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE> empty;
+    node.aggregator.writeSummary(sensors.as<JsonObject>(), empty.to<JsonObject>());
+    CHECK(!empty.containsKey("broken"));
+}
+
+TEST(energy_adds_up_across_windows) {
+    AggregatorNode node;
+    CHECK(node.aggregator.addChannel("pump_power", readPump, 30, true));  // Period doesn't divide the windows
+
+    // Publishes at uneven times, as a busy loop() would
+    const unsigned long windows[] = { 1000, 1337, 999, 2503, 61 };
+    unsigned long elapsed = 0;
+    double energyWh = 0;
+    for (unsigned long window : windows) {
+        node.sample(window);
+        elapsed += window;
+
+        StaticJsonDocument<256> sensors;
+        StaticJsonDocument<MAX_AGGREGATED_SENSORS * STATS_DOC_SIZE> stats;
+        node.aggregator.writeSummary(sensors.to<JsonObject>(), stats.to<JsonObject>());
+        node.aggregator.reset();
+        energyWh += stats["pump_power"]["energy_wh"] | 0.0;
+    }
+
+    // From the first sample to the last publish
+    double expectedWh = 750.0 * elapsed / 1000.0 / 3600.0;
+    CHECK_NEAR(energyWh, expectedWh, expectedWh * 1e-5);
+}
+
+TEST_MAIN()
@@ -0,0 +1,136 @@
+/*
+ * StreamingStats (Arduino library, no Arduino dependency): moments
+ * against a two-pass reference, the P-square p95 against sorted data,
+ * the nearest-rank path for the first samples, the trapezoid integral,
+ * and failed reads.
+ */
+
+#include "SmartFarmStats.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Nearest-rank 95th percentile
+static double sortedP95(std::vector<float> values) {
+    std::sort(values.begin(), values.end());
+    size_t rank = (size_t)std::ceil(0.95 * values.size());
+    return values[rank - 1];
+}
+
+TEST(moments_match_two_pass_reference) {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(40.0f, 12.0f);
+    std::vector<float> values;
+    StreamingStats stats;
+    for (int i = 0; i < 10000; i++) {
+        values.push_back(noise(rng));
+        stats.add(values.back(), 0.01f);
+    }
+
+    double sum = 0;
+    for (float v : values) {
+        sum += v;
+    }
+    double mean = sum / values.size();
+    double squares = 0;
+    for (float v : values) {
+        squares += (v - mean) * (v - mean);
+    }
+    double stddev = std::sqrt(squares / (values.size() - 1));
+
+    CHECK_EQ(stats.getCount(), values.size());
+    CHECK_EQ(stats.getMin(), *std::min_element(values.begin(), values.end()));
+    CHECK_EQ(stats.getMax(), *std::max_element(values.begin(), values.end()));
+    CHECK_NEAR(stats.getMean(), mean, 1e-3);
+    CHECK_NEAR(stats.getStdDev(), stddev, 1e-3);
+}
+
+TEST(p95_tracks_sorted_data) {
+    std::mt19937 rng(11);
+    std::exponential_distribution<float> exponential(1.0f);
+    std::vector<float> values;
+    StreamingStats stats;
+    for (int i = 0; i < 5000; i++) {
+        values.push_back(exponential(rng));
+        stats.add(values.back());
+    }
+
+    double expected = sortedP95(values);  // ~ln(20) = 3.0
+    CHECK_NEAR(stats.getP95(), expected, 0.03 * expected);
+}
+
+TEST(first_five_samples_use_nearest_rank) {
+    const float samples[] = { 5.0f, 1.0f, 4.0f, 2.0f, 3.0f };
+    StreamingStats stats;
+    CHECK_EQ(stats.getP95(), 0);
+
+    std::vector<float> seen;
+    for (float value : samples) {
+        stats.add(value);
+        seen.push_back(value);
+        CHECK_EQ(stats.getP95(), sortedP95(seen));
+    }
+    CHECK_EQ(stats.getP95(), 5.0);
+}
+
+TEST(integral_uses_trapezoids) {
+    StreamingStats constant;
+    for (int i = 0; i < 101; i++) {
+        constant.add(50.0f, i == 0 ? 0 : 0.1f);  // 50 W for 10 s
+    }
+    CHECK_NEAR(constant.getIntegral(), 500.0, 1e-3);
+
+    // Ramp 0..100 W over 10 s: exact for the trapezoid rule
+    StreamingStats ramp;
+    for (int i = 0; i <= 100; i++) {
+        ramp.add((float)i, i == 0 ? 0 : 0.1f);
+    }
+    CHECK_NEAR(ramp.getIntegral(), 500.0, 1e-3);
+}
+
+TEST(boundary_trapezoid_is_split_between_windows) {
+    StreamingStats stats;
+    stats.add(10.0f, 0);
+    stats.add(20.0f, 1.0f);
+
+    // Boundary 0.5 s after the last sample: the closing window holds 20 up to it
+    CHECK_NEAR(stats.getIntegral(0.5f), 15.0 + 10.0, 1e-6);
+    stats.startWindow(0.5f);
+    CHECK_EQ(stats.getCount(), 0);
+    CHECK_EQ(stats.getIntegral(), 0);
+
+    // Next sample 2 s after the last one: 20 -> 40 over the 1.5 s since the boundary
+    CHECK(stats.add(40.0f, 2.0f));
+    CHECK_NEAR(stats.getIntegral(), 45.0, 1e-6);
+    CHECK_EQ(stats.getMin(), 40.0);
+}
+
+TEST(failed_reads_are_counted_and_skipped) {
+    StreamingStats stats;
+    CHECK(stats.add(10.0f, 0));
+    CHECK(!stats.add(NAN, 1.0f));
+    CHECK(!stats.add(SENSOR_ERROR_VALUE, 1.0f));
+    CHECK(!stats.add(INFINITY, 1.0f));
+    CHECK(stats.add(20.0f, 1.0f));
+
+    CHECK_EQ(stats.getCount(), 2);
+    CHECK_EQ(stats.getRejected(), 3);
+    CHECK_EQ(stats.getMin(), 10.0);
+    CHECK_EQ(stats.getMax(), 20.0);
+    CHECK_NEAR(stats.getMean(), 15.0, 1e-6);
+    CHECK_EQ(stats.getP95(), 20.0);
+
+    // The 3 s of failed reads are bridged: 10 -> 20 over 4 s
+    CHECK_NEAR(stats.getIntegral(), 60.0, 1e-6);
+
+    stats.reset();
+    CHECK_EQ(stats.getRejected(), 0);
+    CHECK(!stats.add(NAN, 0));
+    CHECK(stats.add(5.0f, 1.0f));  // First good sample starts the integral
+    CHECK_EQ(stats.getIntegral(), 0);
+}
+
+TEST_MAIN()
@@ -0,0 +1,311 @@
+/*
+ * TelemetryUploader against StandInSink: coalescing, unknown devices,
+ * concurrent flushes, and crashes around the database commit (checked
+ * through the upload watermark: no duplicates, no losses).
+ */
+
+#include "TelemetryUploader.h"
+#include "StandInSink.h"
+#include "TestSupport.h"
+
+#include <ctime>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+static std::string deviceName(int i) {
+    return "ESP32_" + std::to_string(i);
+}
+
+static void registerDevices(StandInSink& sink, int count) {
+    for (int i = 0; i < count; i++) {
+        sink.devices.insert(deviceName(i));
+    }
+}
+
+// Every submitted value reached the sink exactly once
+static void checkExactlyOnce(const StandInSink& sink, int submitted) {
+    std::vector<int> seen(submitted, 0);
+    for (const StandInSink::Row& row : sink.rows) {
+        int value = (int)row.value;
+        CHECK(value >= 0 && value < submitted);
+        if (value >= 0 && value < submitted) {
+            seen[value]++;
+        }
+    }
+    int missing = 0, duplicated = 0;
+    for (int count : seen) {
+        missing += count == 0;
+        duplicated += count > 1;
+    }
+    CHECK_EQ(missing, 0);
+    CHECK_EQ(duplicated, 0);
+}
+
+TEST(batches_and_coalesces_last_seen) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 3);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(100);
+    for (int i = 0; i < 250; i++) {
+        TelemetryRecord record = makeRecord(deviceName(i % 3).c_str(), i, 250 - i);
+        record.receivedAt = 1000 + i;
+        CHECK(uploader.submit(record));
+    }
+
+    while (wal.pending() > 0) {
+        CHECK(uploader.flush());
+    }
+
+    CHECK_EQ(sink.batches, 3);
+    CHECK_EQ(sink.rows.size(), 250);
+    CHECK_EQ(sink.watermark, 250);
+    CHECK_EQ(sink.lastSeen[deviceName(0)], 1000 + 249);
+    CHECK_EQ(sink.lastSeen[deviceName(2)], 1000 + 248);  // Receive time, not the device clock
+
+    UploaderStats stats = uploader.getStats();
+    CHECK_EQ(stats.rowsUploaded, 250);
+    CHECK_EQ(stats.deviceUpdates, 9);  // 3 devices x 3 batches
+    CHECK_EQ(sink.lookups, 1);         // Cached after the first batch
+}
+
+TEST(submit_stamps_receive_time) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 1);
+
+    TelemetryUploader uploader(wal, sink);
+    int64_t before = (int64_t)std::time(nullptr);
+    CHECK(uploader.submit(makeRecord(deviceName(0).c_str(), 1, 42)));  // Device uptime, not a date
+    int64_t after = (int64_t)std::time(nullptr);
+    CHECK(uploader.flush());
+
+    int64_t seen = sink.lastSeen[deviceName(0)];
+    CHECK(seen >= before && seen <= after);
+}
+
+TEST(failed_batch_stays_in_wal) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 1);
+
+    TelemetryUploader uploader(wal, sink);
+    for (int i = 0; i < 10; i++) {
+        uploader.submit(makeRecord(deviceName(0).c_str(), i, i));
+    }
+
+    sink.failWrites = true;
+    CHECK(!uploader.flush());
+    CHECK_EQ(wal.pending(), 10);
+
+    sink.failWrites = false;
+    CHECK(uploader.flush());
+    CHECK_EQ(wal.pending(), 0);
+    checkExactlyOnce(sink, 10);
+}
+
+TEST(unknown_device_is_rechecked_after_ttl) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setUnknownDeviceTtl(50);
+
+    uploader.submit(makeRecord("ESP32_NEW", 1, 1));
+    CHECK(uploader.flush());
+    CHECK_EQ(uploader.getStats().rejectedUnknownDevice, 1);
+
+    // Registered now, but still inside the TTL: not looked up again
+    sink.devices.insert("ESP32_NEW");
+    uploader.submit(makeRecord("ESP32_NEW", 2, 2));
+    CHECK(uploader.flush());
+    CHECK_EQ(uploader.getStats().rejectedUnknownDevice, 2);
+    CHECK_EQ(sink.lookups, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    uploader.submit(makeRecord("ESP32_NEW", 3, 3));
+    CHECK(uploader.flush());
+    CHECK_EQ(uploader.getStats().rejectedUnknownDevice, 2);
+    CHECK_EQ(sink.rows.size(), 1);
+    CHECK_EQ(sink.rows[0].value, 3);
+}
+
+TEST(deleted_device_does_not_block_later_batches) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 2);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(10);
+    for (int i = 0; i < 10; i++) {
+        uploader.submit(makeRecord(deviceName(i % 2).c_str(), i, i));
+    }
+    CHECK(uploader.flush());
+    CHECK_EQ(sink.lookups, 1);
+
+    // Deleted while still cached as known: the next write hits the foreign key
+    sink.devices.erase(deviceName(1));
+    for (int i = 10; i < 40; i++) {
+        uploader.submit(makeRecord(deviceName(i % 2).c_str(), i, i));
+    }
+    while (wal.pending() > 0) {
+        CHECK(uploader.flush());
+    }
+
+    CHECK_EQ(sink.watermark, 40);
+    CHECK_EQ(sink.rows.size(), 10 + 15);
+    CHECK_EQ(sink.rejectedBatches, 1);  // Re-resolved once, not per batch
+    UploaderStats stats = uploader.getStats();
+    CHECK_EQ(stats.rejectedUnknownDevice, 15);
+    CHECK_EQ(stats.rejectedPermanent, 0);
+}
+
+TEST(rejected_row_is_skipped_and_counted) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 1);
+    sink.badSeqs.insert(7);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(16);
+    for (int i = 0; i < 32; i++) {
+        uploader.submit(makeRecord(deviceName(0).c_str(), i, i));
+    }
+    while (wal.pending() > 0) {
+        CHECK(uploader.flush());
+    }
+
+    CHECK_EQ(sink.watermark, 32);
+    CHECK_EQ(sink.rows.size(), 31);
+    for (const StandInSink::Row& row : sink.rows) {
+        CHECK(row.seq != 7);
+    }
+    CHECK_EQ(uploader.getStats().rejectedPermanent, 1);
+}
+
+TEST(known_device_is_rechecked_after_ttl) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1024));
+    StandInSink sink;
+    registerDevices(sink, 1);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setKnownDeviceTtl(50);
+
+    uploader.submit(makeRecord(deviceName(0).c_str(), 1, 1));
+    CHECK(uploader.flush());
+    uploader.submit(makeRecord(deviceName(0).c_str(), 2, 2));
+    CHECK(uploader.flush());
+    CHECK_EQ(sink.lookups, 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    uploader.submit(makeRecord(deviceName(0).c_str(), 3, 3));
+    CHECK(uploader.flush());
+    CHECK_EQ(sink.lookups, 2);
+    CHECK_EQ(sink.rows.size(), 3);
+}
+
+TEST(flush_while_worker_runs) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 1 << 16));
+    StandInSink sink;
+    registerDevices(sink, 50);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(64);
+    uploader.setUploadInterval(1);
+    uploader.start();
+
+    const int total = 40000;
+    std::thread flusher([&]() {
+        while (wal.tail() - 1 < (uint64_t)total || wal.pending() > 0) {
+            uploader.flush();
+        }
+    });
+    for (int i = 0; i < total; i++) {
+        while (!uploader.submit(makeRecord(deviceName(i % 50).c_str(), i, i))) {
+            std::this_thread::yield();
+        }
+    }
+    flusher.join();
+    uploader.stop();
+
+    CHECK_EQ(sink.rows.size(), (size_t)total);
+    checkExactlyOnce(sink, total);
+}
+
+// Runs an uploader in a child process that dies at the given point of the
+// crashOnBatch-th batch, then finishes the upload in this process
+static void crashAndRecover(StandInSink::CrashPoint point) {
+    TempDir dir;
+    std::string walPath = dir.file("telemetry.wal");
+    std::string dbPath = dir.file("database");
+    const int total = 3000;
+
+    pid_t child = fork();
+    if (child == 0) {
+        TelemetryWal wal;
+        wal.open(walPath, 4096);
+        StandInSink sink(dbPath);
+        registerDevices(sink, 10);
+        sink.crashPoint = point;
+        sink.crashOnBatch = 3;
+
+        TelemetryUploader uploader(wal, sink);
+        uploader.setBatchSize(500);
+        for (int i = 0; i < total; i++) {
+            uploader.submit(makeRecord(deviceName(i % 10).c_str(), i, i));
+        }
+        while (wal.pending() > 0) {
+            uploader.flush();
+        }
+        _exit(0);  // Not reached
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == CRASH_EXIT_STATUS);
+
+    TelemetryWal wal;
+    CHECK(wal.open(walPath, 4096));
+    StandInSink sink(dbPath);
+    registerDevices(sink, 10);
+    size_t rowsBeforeRestart = sink.rows.size();
+    CHECK_EQ(rowsBeforeRestart, point == StandInSink::CRASH_AFTER_COMMIT ? 1500 : 1000);
+
+    TelemetryUploader uploader(wal, sink);
+    uploader.setBatchSize(500);
+    while (wal.pending() > 0) {
+        CHECK(uploader.flush());
+    }
+
+    CHECK_EQ(sink.rows.size(), (size_t)total);
+    CHECK_EQ(sink.watermark, (uint64_t)total);
+    checkExactlyOnce(sink, total);
+}
+
+TEST(crash_after_database_commit_is_not_uploaded_twice) {
+    crashAndRecover(StandInSink::CRASH_AFTER_COMMIT);
+}
+
+TEST(crash_inside_transaction_is_uploaded_again) {
+    crashAndRecover(StandInSink::CRASH_BEFORE_COMMIT);
+}
+
+TEST_MAIN()
@@ -0,0 +1,144 @@
+/*
+ * TelemetryValidator: the AVX2 and portable kernels against a per-sample
+ * reference, partial words, duplicates across word boundaries, presence
+ * bitmaps and the per-rule counts.
+ */
+
+#include "TelemetryValidator.h"
+#include "TestSupport.h"
+#include "ValidationReference.h"
+
+#include <vector>
+
+static bool sameResult(const TelemetryBatch& batch, void (*kernel)(const TelemetryBatch&, uint64_t*, ValidationResult&)) {
+    size_t words = validationBitmapWords(batch.count);
+    std::vector<uint64_t> expectedBitmap(words), bitmap(words, ~0ull);
+    ValidationResult expected, result;
+    validateBatchReference(batch, expectedBitmap.data(), expected);
+    kernel(batch, bitmap.data(), result);
+
+    bool same = bitmap == expectedBitmap && result.valid == expected.valid;
+    for (int rule = 0; rule < RULE_COUNT; rule++) {
+        same = same && result.rejects[rule] == expected.rejects[rule];
+    }
+    return same;
+}
+
+TEST(kernels_match_reference_on_mixed_replay) {
+    SyntheticReplay replay(100000, 0.05, 0.2);
+    CHECK(sameResult(replay.batch, validateBatch));
+    CHECK(sameResult(replay.batch, validateBatchScalar));
+
+    ValidationResult result;
+    std::vector<uint64_t> bitmap(validationBitmapWords(replay.batch.count));
+    validateBatch(replay.batch, bitmap.data(), result);
+    CHECK(result.valid > 0 && result.valid < replay.batch.count);
+    for (int rule = 0; rule < RULE_COUNT; rule++) {
+        CHECK(result.rejects[rule] > 0);  // The replay exercises every rule
+    }
+}
+
+TEST(partial_words_and_small_batches) {
+    const size_t sizes[] = { 0, 1, 7, 8, 63, 64, 65, 127, 128, 129, 200, 1000 };
+    for (size_t count : sizes) {
+        SyntheticReplay replay(count, 0.1, 0.3, (uint32_t)count + 7);
+        CHECK(sameResult(replay.batch, validateBatch));
+        CHECK(sameResult(replay.batch, validateBatchScalar));
+    }
+}
+
+TEST(duplicates_across_word_boundaries) {
+    const size_t count = 256;
+    std::vector<int64_t> timestamps(count);
+    std::vector<uint32_t> devices(count, 0);
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = 1000 + (int64_t)i;
+    }
+    timestamps[64] = timestamps[63];    // First sample of word 1
+    timestamps[128] = timestamps[127];  // First sample of word 2, but another device
+    devices[128] = 1;
+    for (size_t i = 129; i < count; i++) {
+        devices[i] = 1;
+    }
+    timestamps[200] = timestamps[199];
+
+    TelemetryBatch batch = {};
+    batch.count = count;
+    batch.timestamps = timestamps.data();
+    batch.deviceIndex = devices.data();
+
+    for (auto kernel : { validateBatch, validateBatchScalar }) {
+        std::vector<uint64_t> bitmap(validationBitmapWords(count));
+        ValidationResult result;
+        kernel(batch, bitmap.data(), result);
+        CHECK_EQ(result.rejects[RULE_DUPLICATE_TIMESTAMP], 2);
+        CHECK_EQ(result.valid, count - 2);
+        CHECK_EQ(bitmap[1] & 1, 0);
+        CHECK_EQ(bitmap[2] & 1, 1);
+        CHECK_EQ((bitmap[3] >> (200 - 192)) & 1, 0);
+    }
+}
+
+TEST(absent_fields_are_not_checked) {
+    const size_t count = 130;
+    std::vector<int64_t> timestamps(count);
+    std::vector<float> temperature(count, 25.0f);
+    std::vector<float> humidity(count, 60.0f);
+    std::vector<uint64_t> humidityPresent(validationBitmapWords(count), ~0ull);
+    for (size_t i = 0; i < count; i++) {
+        timestamps[i] = (int64_t)i;
+    }
+
+    // Absent humidity holds NaN, -999 and out-of-range garbage
+    const size_t absent[] = { 3, 64, 129 };
+    humidity[3] = NAN;
+    humidity[64] = SENSOR_ERROR_VALUE;
+    humidity[129] = 500.0f;
+    for (size_t i : absent) {
+        humidityPresent[i / 64] &= ~(1ull << (i % 64));
+    }
+    humidity[10] = 500.0f;  // Present and out of range
+
+    TelemetryBatch batch = {};
+    batch.count = count;
+    batch.timestamps = timestamps.data();
+    batch.temperature = { temperature.data(), nullptr };
+    batch.humidity = { humidity.data(), humidityPresent.data() };
+
+    for (auto kernel : { validateBatch, validateBatchScalar }) {
+        std::vector<uint64_t> bitmap(validationBitmapWords(count));
+        ValidationResult result;
+        kernel(batch, bitmap.data(), result);
+        CHECK_EQ(result.valid, count - 1);
+        CHECK_EQ(result.rejects[RULE_HUMIDITY_RANGE], 1);
+        CHECK_EQ(result.rejects[RULE_NAN], 0);
+        CHECK_EQ(result.rejects[RULE_SENTINEL], 0);
+        CHECK_EQ((bitmap[0] >> 10) & 1, 0);
+    }
+
+    // Without the bitmap the same batch rejects them
+    batch.humidity.present = nullptr;
+    std::vector<uint64_t> bitmap(validationBitmapWords(count));
+    ValidationResult result;
+    validateBatch(batch, bitmap.data(), result);
+    CHECK_EQ(result.valid, count - 4);
+    CHECK_EQ(result.rejects[RULE_NAN], 1);
+    CHECK_EQ(result.rejects[RULE_SENTINEL], 1);
+}
+
+TEST(range_limits_are_inclusive) {
+    std::vector<int64_t> timestamps = { 1, 2, 3, 4 };
+    std::vector<float> ph = { 0.0f, 14.0f, -0.001f, 14.001f };
+    TelemetryBatch batch = {};
+    batch.count = 4;
+    batch.timestamps = timestamps.data();
+    batch.ph = { ph.data(), nullptr };
+
+    uint64_t bitmap = 0;
+    ValidationResult result;
+    validateBatch(batch, &bitmap, result);
+    CHECK_EQ(bitmap, 0x3);
+    CHECK_EQ(result.rejects[RULE_PH_RANGE], 2);
+}
+
+TEST_MAIN()
@@ -0,0 +1,189 @@
+/*
+ * TelemetryWal: append/read/commit, full log, string termination,
+ * recovery of records written before a crash and of a torn or short file.
+ */
+
+#include "TelemetryWal.h"
+#include "StandInSink.h"
+#include "TestSupport.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TEST(append_read_commit) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 64));
+
+    for (int i = 0; i < 10; i++) {
+        CHECK(wal.append(makeRecord("ESP32_001", i, 1000 + i)));
+    }
+    CHECK_EQ(wal.pending(), 10);
+
+    std::vector<WalEntry> entries;
+    CHECK_EQ(wal.read(wal.head(), 4, entries), 4);
+    CHECK_EQ(entries[0].seq, 1);
+    CHECK_EQ(entries[3].record.value, 3);
+
+    wal.commit(entries.back().seq);
+    CHECK_EQ(wal.pending(), 6);
+    CHECK_EQ(wal.read(wal.head(), 100, entries), 6);
+    CHECK_EQ(entries[0].seq, 5);
+    CHECK_EQ(entries[0].record.timestamp, 1004);
+}
+
+TEST(full_log_rejects_appends) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 16));
+
+    for (int i = 0; i < 16; i++) {
+        CHECK(wal.append(makeRecord("ESP32_001", i, i)));
+    }
+    CHECK(!wal.append(makeRecord("ESP32_001", 16, 16)));
+
+    // Committing frees slots; the ring wraps around
+    wal.commit(8);
+    CHECK(wal.append(makeRecord("ESP32_001", 16, 16)));
+    std::vector<WalEntry> entries;
+    wal.read(wal.head(), 100, entries);
+    CHECK_EQ(entries.size(), 9);
+    CHECK_EQ(entries.back().record.value, 16);
+}
+
+TEST(strings_are_terminated) {
+    TempDir dir;
+    TelemetryWal wal;
+    CHECK(wal.open(dir.file("telemetry.wal"), 16));
+
+    TelemetryRecord record;
+    memset(&record, 'A', sizeof(record));
+    record.value = 1;
+    CHECK(wal.append(record));
+
+    std::vector<WalEntry> entries;
+    wal.read(wal.head(), 1, entries);
+    CHECK_EQ(strlen(entries[0].record.deviceId), sizeof(record.deviceId) - 1);
+    CHECK_EQ(strlen(entries[0].record.sensorType), sizeof(record.sensorType) - 1);
+    CHECK_EQ(strlen(entries[0].record.protocolVersion), sizeof(record.protocolVersion) - 1);
+}
+
+TEST(reopen_recovers_records_not_counted_in_header) {
+    TempDir dir;
+    std::string path = dir.file("telemetry.wal");
+    {
+        TelemetryWal wal;
+        CHECK(wal.open(path, 64));
+        for (int i = 0; i < 20; i++) {
+            // Garbage in the padding must not break the checksum
+            TelemetryRecord record;
+            memset(&record, 0xA5, sizeof(record));
+            TelemetryRecord fields = makeRecord("ESP32_001", i, i);
+            memcpy(record.deviceId, fields.deviceId, sizeof(fields.deviceId));
+            memcpy(record.sensorType, fields.sensorType, sizeof(fields.sensorType));
+            record.value = i;
+            record.timestamp = i;
+            CHECK(wal.append(record));
+        }
+        wal.commit(5);
+    }
+
+    // Crash after the slots were written but before the header tail was:
+    // the header is a prefix of the file (magic, version, capacity, head, tail)
+    int fd = open(path.c_str(), O_RDWR);
+    uint64_t staleTail = 12;
+    CHECK(pwrite(fd, &staleTail, sizeof(staleTail), 24) == (ssize_t)sizeof(staleTail));
+    close(fd);
+
+    TelemetryWal wal;
+    CHECK(wal.open(path, 64));
+    CHECK_EQ(wal.head(), 6);
+    CHECK_EQ(wal.tail(), 21);
+
+    std::vector<WalEntry> entries;
+    wal.read(wal.head(), 100, entries);
+    CHECK_EQ(entries.size(), 15);
+    for (size_t i = 0; i < entries.size(); i++) {
+        CHECK_EQ(entries[i].seq, 6 + i);
+        CHECK_EQ(entries[i].record.value, 5 + (double)i);
+    }
+}
+
+TEST(torn_slot_ends_recovery) {
+    TempDir dir;
+    std::string path = dir.file("telemetry.wal");
+    {
+        TelemetryWal wal;
+        CHECK(wal.open(path, 64));
+        for (int i = 0; i < 10; i++) {
+            CHECK(wal.append(makeRecord("ESP32_001", i, i)));
+        }
+    }
+
+    // Header says 4 records; slot of seq 7 is corrupted
+    int fd = open(path.c_str(), O_RDWR);
+    uint64_t staleTail = 5;
+    CHECK(pwrite(fd, &staleTail, sizeof(staleTail), 24) == (ssize_t)sizeof(staleTail));
+    const size_t headerSize = 32;
+    const size_t slotSize = 16 + sizeof(TelemetryRecord);
+    double corrupt = 1e9;
+    CHECK(pwrite(fd, &corrupt, sizeof(corrupt), headerSize + 7 * slotSize + 16 + 64) == (ssize_t)sizeof(corrupt));
+    close(fd);
+
+    TelemetryWal wal;
+    CHECK(wal.open(path, 64));
+    CHECK_EQ(wal.tail(), 7);
+}
+
+TEST(corrupt_slot_before_tail_truncates_log) {
+    TempDir dir;
+    std::string path = dir.file("telemetry.wal");
+    {
+        TelemetryWal wal;
+        CHECK(wal.open(path, 64));
+        for (int i = 0; i < 10; i++) {
+            CHECK(wal.append(makeRecord("ESP32_001", i, i)));
+        }
+    }
+
+    // The header counts all 10 records, but the page of seq 6 never made it
+    int fd = open(path.c_str(), O_RDWR);
+    const size_t headerSize = 32;
+    const size_t slotSize = 16 + sizeof(TelemetryRecord);
+    std::vector<char> zeros(slotSize, 0);
+    CHECK(pwrite(fd, zeros.data(), zeros.size(), headerSize + 6 * slotSize) == (ssize_t)zeros.size());
+    close(fd);
+
+    TelemetryWal wal;
+    CHECK(wal.open(path, 64));
+    std::vector<WalEntry> entries;
+    CHECK_EQ(wal.read(wal.head(), 100, entries), 5);
+    CHECK_EQ(entries.back().seq, 5);
+    CHECK_EQ(wal.tail(), 6);
+
+    // Appends continue from the truncated tail
+    CHECK(wal.append(makeRecord("ESP32_001", 42, 42)));
+    CHECK_EQ(wal.read(6, 100, entries), 1);
+    CHECK_EQ(entries[0].record.value, 42);
+}
+
+TEST(short_file_is_rejected) {
+    TempDir dir;
+    std::string path = dir.file("telemetry.wal");
+    {
+        TelemetryWal wal;
+        CHECK(wal.open(path, 64));
+        CHECK(wal.append(makeRecord("ESP32_001", 1, 1)));
+    }
+
+    struct stat st;
+    CHECK(stat(path.c_str(), &st) == 0);
+    CHECK(truncate(path.c_str(), st.st_size / 2) == 0);
+
+    TelemetryWal wal;
+    CHECK(!wal.open(path, 64));
+}
+
+TEST_MAIN()
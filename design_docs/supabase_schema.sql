@@ -197,3 +197,19 @@ ON public.user_installations FOR INSERT WITH CHECK (auth.uid() = user_id);
 
 CREATE POLICY "Users can uninstall items" 
 ON public.user_installations FOR DELETE USING (auth.uid() = user_id);
+
+
+-- 8. EDGE HUB UPLOADER PROGRESS
+-- Last WAL sequence committed by each batched uploader (design_docs/edge_hub).
+-- Updated in the same transaction as the telemetry rows so a crash mid-batch
+-- never duplicates or loses data.
+ALTER TABLE public.devices ADD COLUMN IF NOT EXISTS last_seen TIMESTAMPTZ;
+
+CREATE TABLE IF NOT EXISTS public.iot_uploader_progress (
+    uploader_id TEXT PRIMARY KEY,
+    last_seq BIGINT NOT NULL DEFAULT 0,
+    updated_at TIMESTAMPTZ DEFAULT NOW()
+);
+
+-- RLS: service role only (no user policies)
+ALTER TABLE public.iot_uploader_progress ENABLE ROW LEVEL SECURITY;
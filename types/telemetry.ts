@@ -13,6 +13,19 @@ export interface SensorData {
     flow_rate?: number;        // L/min
 }
 
+// Window summary of a high-rate sampled sensor (SensorAggregator)
+// (only samples and rejected when every read of the window failed)
+export interface SensorStats {
+    min?: number;
+    max?: number;
+    mean?: number;
+    stddev?: number;
+    p95?: number;              // approximate (P-square)
+    samples: number;           // good reads
+    energy_wh?: number;        // power channels only
+    rejected?: number;         // failed reads (NaN, -999) left out, when any
+}
+
 export interface TelemetryMessage {
     device_id: string;
     timestamp: number;         // Unix epoch
@@ -20,6 +33,7 @@ export interface TelemetryMessage {
     battery_voltage?: number;  // V (0 to 5)
     rssi?: number;             // dBm (-120 to 0)
     protocol_version?: string; // e.g., "1.0"
+    stats?: Record<string, SensorStats>;
 }
 
 export interface DeviceStatus {